@@ -0,0 +1,322 @@
+#include "PhysicsWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+std::size_t PhysicsWorld::addBody(sf::Vector2f center, sf::Vector2f size, sf::Vector2f velocity, float angular_velocity){
+    pos_x_.push_back(center.x);
+    pos_y_.push_back(center.y);
+    vel_x_.push_back(velocity.x);
+    vel_y_.push_back(velocity.y);
+    half_w_.push_back(size.x / 2.f);
+    half_h_.push_back(size.y / 2.f);
+    extent_x_.push_back(size.x / 2.f);
+    extent_y_.push_back(size.y / 2.f);
+    angle_.push_back(0.f);
+    angular_velocity_.push_back(angular_velocity);
+    float area = size.x * size.y;
+    inverse_mass_.push_back(area > 0.f ? 1.f / area : 0.f);
+    hit_wall_.push_back(0);
+    order_valid_ = false;
+    return pos_x_.size() - 1;
+}
+
+void PhysicsWorld::clear(){
+    pos_x_.clear();
+    pos_y_.clear();
+    vel_x_.clear();
+    vel_y_.clear();
+    half_w_.clear();
+    half_h_.clear();
+    extent_x_.clear();
+    extent_y_.clear();
+    angle_.clear();
+    angular_velocity_.clear();
+    inverse_mass_.clear();
+    hit_wall_.clear();
+    order_.clear();
+    order_valid_ = false;
+}
+
+void PhysicsWorld::reserve(std::size_t count){
+    pos_x_.reserve(count);
+    pos_y_.reserve(count);
+    vel_x_.reserve(count);
+    vel_y_.reserve(count);
+    half_w_.reserve(count);
+    half_h_.reserve(count);
+    extent_x_.reserve(count);
+    extent_y_.reserve(count);
+    angle_.reserve(count);
+    angular_velocity_.reserve(count);
+    inverse_mass_.reserve(count);
+    hit_wall_.reserve(count);
+}
+
+void PhysicsWorld::setBounds(const sf::FloatRect &bounds){
+    bounds_ = bounds;
+}
+
+void PhysicsWorld::setGravity(sf::Vector2f gravity){
+    gravity_ = gravity;
+}
+
+void PhysicsWorld::setRestitution(float restitution){
+    restitution_ = std::min(1.f, std::max(0.f, restitution));
+}
+
+void PhysicsWorld::setBodyCollisions(bool enabled){
+    body_collisions_ = enabled;
+}
+
+void PhysicsWorld::step(float dt){
+    integrate(dt);
+    bounceOffWalls();
+    pair_tests_ = 0;
+    contacts_ = 0;
+    if (body_collisions_){
+        collideBodies();
+    }
+}
+
+void PhysicsWorld::integrate(float dt){
+    const float degrees = 3.14159265f / 180.f;
+    std::size_t n = size();
+    for (std::size_t i = 0; i < n; i++){
+        vel_x_[i] += gravity_.x * dt;
+        vel_y_[i] += gravity_.y * dt;
+        pos_x_[i] += vel_x_[i] * dt;
+        pos_y_[i] += vel_y_[i] * dt;
+    }
+    for (std::size_t i = 0; i < n; i++){
+        if (angular_velocity_[i] == 0.f){
+            continue;
+        }
+        angle_[i] = std::fmod(angle_[i] + angular_velocity_[i] * dt, 360.f);
+        float c = std::fabs(std::cos(angle_[i] * degrees));
+        float s = std::fabs(std::sin(angle_[i] * degrees));
+        extent_x_[i] = c * half_w_[i] + s * half_h_[i];
+        extent_y_[i] = s * half_w_[i] + c * half_h_[i];
+    }
+}
+
+void PhysicsWorld::bounceOffWalls(){
+    float left = bounds_.left;
+    float top = bounds_.top;
+    float right = bounds_.left + bounds_.width;
+    float bottom = bounds_.top + bounds_.height;
+    std::size_t n = size();
+    for (std::size_t i = 0; i < n; i++){
+        // Pushed back inside as well, so a body never stays in the wall
+        // and flips its velocity again the next step
+        unsigned char hit = 0;
+        if (pos_x_[i] - extent_x_[i] <= left){
+            vel_x_[i] = std::fabs(vel_x_[i]);
+            pos_x_[i] = left + extent_x_[i];
+            hit = 1;
+        } else if (pos_x_[i] + extent_x_[i] >= right){
+            vel_x_[i] = -std::fabs(vel_x_[i]);
+            pos_x_[i] = right - extent_x_[i];
+            hit = 1;
+        }
+        if (pos_y_[i] - extent_y_[i] <= top){
+            vel_y_[i] = std::fabs(vel_y_[i]);
+            pos_y_[i] = top + extent_y_[i];
+            hit = 1;
+        } else if (pos_y_[i] + extent_y_[i] >= bottom){
+            vel_y_[i] = -std::fabs(vel_y_[i]);
+            pos_y_[i] = bottom - extent_y_[i];
+            hit = 1;
+        }
+        hit_wall_[i] = hit;
+    }
+}
+
+void PhysicsWorld::collideBodies(){
+    std::size_t n = size();
+    if (n < 2){
+        return;
+    }
+
+    // Sweep along the axis the bodies are spread out more on, so that fewer
+    // of them overlap along it. It only changes on a clear difference, as
+    // every change costs a full sort.
+    double sum_x = 0, sum_y = 0, square_x = 0, square_y = 0;
+    for (std::size_t i = 0; i < n; i++){
+        sum_x += pos_x_[i];
+        sum_y += pos_y_[i];
+        square_x += double(pos_x_[i]) * pos_x_[i];
+        square_y += double(pos_y_[i]) * pos_y_[i];
+    }
+    double variance_x = square_x / n - (sum_x / n) * (sum_x / n);
+    double variance_y = square_y / n - (sum_y / n) * (sum_y / n);
+    int axis = sweep_axis_;
+    if (axis == 0 && variance_y > variance_x * 1.5){
+        axis = 1;
+    } else if (axis == 1 && variance_x > variance_y * 1.5){
+        axis = 0;
+    }
+    if (axis != sweep_axis_ || order_.size() != n){
+        sweep_axis_ = axis;
+        order_valid_ = false;
+    }
+
+    const std::vector<float> &pos_a = axis == 0 ? pos_x_ : pos_y_;
+    const std::vector<float> &extent_a = axis == 0 ? extent_x_ : extent_y_;
+    const std::vector<float> &pos_b = axis == 0 ? pos_y_ : pos_x_;
+    const std::vector<float> &extent_b = axis == 0 ? extent_y_ : extent_x_;
+
+    sorted_min_a_.resize(n);
+    if (!order_valid_){
+        order_.resize(n);
+        std::iota(order_.begin(), order_.end(), 0);
+        std::sort(order_.begin(), order_.end(), [&](std::size_t a, std::size_t b){
+            return pos_a[a] - extent_a[a] < pos_a[b] - extent_a[b];
+        });
+        for (std::size_t i = 0; i < n; i++){
+            sorted_min_a_[i] = pos_a[order_[i]] - extent_a[order_[i]];
+        }
+        order_valid_ = true;
+    } else {
+        // Last step's order is nearly right; insertion sort only moves the
+        // few bodies that passed each other
+        for (std::size_t i = 0; i < n; i++){
+            sorted_min_a_[i] = pos_a[order_[i]] - extent_a[order_[i]];
+        }
+        for (std::size_t i = 1; i < n; i++){
+            float key = sorted_min_a_[i];
+            std::size_t body = order_[i];
+            std::size_t j = i;
+            while (j > 0 && sorted_min_a_[j - 1] > key){
+                sorted_min_a_[j] = sorted_min_a_[j - 1];
+                order_[j] = order_[j - 1];
+                j--;
+            }
+            sorted_min_a_[j] = key;
+            order_[j] = body;
+        }
+    }
+
+    // Bands twice as high as the largest box, so no box touches more than
+    // two of them
+    float lowest = pos_b[0] - extent_b[0];
+    float largest = 0.f;
+    for (std::size_t i = 0; i < n; i++){
+        lowest = std::min(lowest, pos_b[i] - extent_b[i]);
+        largest = std::max(largest, extent_b[i]);
+    }
+    float band_height = std::max(4.f * largest, 1.f);
+    auto bandOf = [&](float b){
+        return static_cast<std::size_t>((b - lowest) / band_height);
+    };
+
+    // Counting sort into the bands, which keeps every band in sweep order
+    band_start_.clear();
+    for (std::size_t i = 0; i < n; i++){
+        std::size_t body = order_[i];
+        std::size_t first = bandOf(pos_b[body] - extent_b[body]);
+        std::size_t last = bandOf(pos_b[body] + extent_b[body]);
+        if (band_start_.size() < last + 2){
+            band_start_.resize(last + 2, 0);
+        }
+        band_start_[first + 1]++;
+        if (last != first){
+            band_start_[last + 1]++;
+        }
+    }
+    for (std::size_t band = 1; band < band_start_.size(); band++){
+        band_start_[band] += band_start_[band - 1];
+    }
+
+    std::size_t entries = band_start_.back();
+    entry_body_.resize(entries);
+    entry_first_band_.resize(entries);
+    entry_min_a_.resize(entries);
+    entry_max_a_.resize(entries);
+    entry_min_b_.resize(entries);
+    entry_max_b_.resize(entries);
+    for (std::size_t i = 0; i < n; i++){
+        std::size_t body = order_[i];
+        float min_b = pos_b[body] - extent_b[body];
+        float max_b = pos_b[body] + extent_b[body];
+        std::size_t first = bandOf(min_b);
+        std::size_t last = bandOf(max_b);
+        for (std::size_t band = first; band <= last; band++){
+            std::size_t entry = band_start_[band]++;
+            entry_body_[entry] = body;
+            entry_first_band_[entry] = first;
+            entry_min_a_[entry] = sorted_min_a_[i];
+            entry_max_a_[entry] = pos_a[body] + extent_a[body];
+            entry_min_b_[entry] = min_b;
+            entry_max_b_[entry] = max_b;
+        }
+    }
+
+    // The fill moved every start to the next band's; each band now ends at
+    // band_start_[band] and starts where the one before it ends. Boxes are
+    // taken from before any contact was resolved this step.
+    std::size_t begin = 0;
+    for (std::size_t band = 0; band + 1 < band_start_.size(); band++){
+        std::size_t end = band_start_[band];
+        for (std::size_t i = begin; i < end; i++){
+            float max_a = entry_max_a_[i];
+            float min_b = entry_min_b_[i];
+            float max_b = entry_max_b_[i];
+            for (std::size_t j = i + 1; j < end && entry_min_a_[j] <= max_a; j++){
+                pair_tests_++;
+                // A pair sharing two bands is resolved in the first
+                if (entry_min_b_[j] <= max_b && entry_max_b_[j] >= min_b &&
+                    band == std::max(entry_first_band_[i], entry_first_band_[j])){
+                    resolve(entry_body_[i], entry_body_[j]);
+                }
+            }
+        }
+        begin = end;
+    }
+}
+
+void PhysicsWorld::resolve(std::size_t a, std::size_t b){
+    float dx = pos_x_[b] - pos_x_[a];
+    float dy = pos_y_[b] - pos_y_[a];
+    float overlap_x = extent_x_[a] + extent_x_[b] - std::fabs(dx);
+    float overlap_y = extent_y_[a] + extent_y_[b] - std::fabs(dy);
+    if (overlap_x <= 0.f || overlap_y <= 0.f){
+        return; // separated by an earlier contact this step
+    }
+
+    float inverse_a = inverse_mass_[a];
+    float inverse_b = inverse_mass_[b];
+    float inverse_total = inverse_a + inverse_b;
+    if (inverse_total <= 0.f){
+        return;
+    }
+    contacts_++;
+
+    // Pushed apart along the axis they overlap least on
+    float normal_x = 0.f, normal_y = 0.f, depth;
+    if (overlap_x < overlap_y){
+        normal_x = dx < 0.f ? -1.f : 1.f;
+        depth = overlap_x;
+    } else {
+        normal_y = dy < 0.f ? -1.f : 1.f;
+        depth = overlap_y;
+    }
+    float push_a = depth * inverse_a / inverse_total;
+    float push_b = depth * inverse_b / inverse_total;
+    pos_x_[a] -= normal_x * push_a;
+    pos_y_[a] -= normal_y * push_a;
+    pos_x_[b] += normal_x * push_b;
+    pos_y_[b] += normal_y * push_b;
+
+    // Only bodies moving towards each other bounce
+    float approach = (vel_x_[b] - vel_x_[a]) * normal_x + (vel_y_[b] - vel_y_[a]) * normal_y;
+    if (approach >= 0.f){
+        return;
+    }
+    float impulse = -(1.f + restitution_) * approach / inverse_total;
+    vel_x_[a] -= impulse * inverse_a * normal_x;
+    vel_y_[a] -= impulse * inverse_a * normal_y;
+    vel_x_[b] += impulse * inverse_b * normal_x;
+    vel_y_[b] += impulse * inverse_b * normal_y;
+}
@@ -0,0 +1,119 @@
+#ifndef PHYSICSWORLD_H
+#define PHYSICSWORLD_H
+
+#include <cstddef>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Bouncing rectangles: they fly at constant velocity (plus gravity, if
+// set), spin, bounce off the walls of the bounds and off each other.
+// A body collides as the axis-aligned box around it as it is rotated, the
+// same box getGlobalBounds() gives for a rotated sf::RectangleShape.
+//
+// Bodies are kept as structure of arrays, one vector per field, so a
+// step walks each field from start to end. Body-body contacts are found
+// by sort and sweep: the boxes stay sorted along one axis from step to
+// step, which is nearly free when little has moved, and only neighbours
+// along that axis whose boxes overlap are resolved.
+class PhysicsWorld{
+public:
+    // center and size in pixels, velocity in pixels/s, angular velocity
+    // in degrees/s. Heavier bodies are bigger ones. Returns the body's
+    // index.
+    std::size_t addBody(sf::Vector2f center, sf::Vector2f size, sf::Vector2f velocity, float angular_velocity = 0.f);
+
+    void clear();
+    void reserve(std::size_t count);
+
+    // Walls the bodies stay inside.
+    void setBounds(const sf::FloatRect &bounds);
+
+    void setGravity(sf::Vector2f gravity);
+
+    // 1 keeps all the speed along the contact normal, 0 keeps none.
+    void setRestitution(float restitution);
+
+    // Off, bodies only bounce off the walls.
+    void setBodyCollisions(bool enabled);
+
+    void step(float dt);
+
+    std::size_t size() const{
+        return pos_x_.size();
+    }
+
+    sf::Vector2f position(std::size_t body) const{
+        return sf::Vector2f(pos_x_[body], pos_y_[body]);
+    }
+
+    sf::Vector2f velocity(std::size_t body) const{
+        return sf::Vector2f(vel_x_[body], vel_y_[body]);
+    }
+
+    void setVelocity(std::size_t body, sf::Vector2f velocity){
+        vel_x_[body] = velocity.x;
+        vel_y_[body] = velocity.y;
+    }
+
+    sf::Vector2f bodySize(std::size_t body) const{
+        return sf::Vector2f(half_w_[body] * 2.f, half_h_[body] * 2.f);
+    }
+
+    // Degrees, like sf::Transformable::getRotation.
+    float angle(std::size_t body) const{
+        return angle_[body];
+    }
+
+    // Whether the body bounced off a wall in the last step.
+    bool hitWall(std::size_t body) const{
+        return hit_wall_[body] != 0;
+    }
+
+    // Box pairs compared and pairs found touching in the last step.
+    std::size_t pairTests() const{
+        return pair_tests_;
+    }
+    std::size_t contacts() const{
+        return contacts_;
+    }
+
+private:
+    void integrate(float dt);
+    void bounceOffWalls();
+    void collideBodies();
+    void resolve(std::size_t a, std::size_t b);
+
+    std::vector<float> pos_x_, pos_y_;
+    std::vector<float> vel_x_, vel_y_;
+    std::vector<float> half_w_, half_h_;
+    std::vector<float> extent_x_, extent_y_; // half size of the rotated box
+    std::vector<float> angle_, angular_velocity_;
+    std::vector<float> inverse_mass_;
+    std::vector<unsigned char> hit_wall_;
+
+    // Sort and sweep: body indices in the order of their boxes' minimum
+    // along sweep_axis_, kept from step to step
+    std::vector<std::size_t> order_;
+    std::vector<float> sorted_min_a_;
+    int sweep_axis_ = 0; // 0 is x, 1 is y
+    bool order_valid_ = false;
+
+    // The sweep runs in bands across the other axis, so that it only meets
+    // bodies near in both. A box is entered in each band it touches (at
+    // most two), in sweep order; the boxes are copied out so the sweep
+    // reads memory front to back.
+    std::vector<std::size_t> band_start_;
+    std::vector<std::size_t> entry_body_;
+    std::vector<std::size_t> entry_first_band_;
+    std::vector<float> entry_min_a_, entry_max_a_, entry_min_b_, entry_max_b_;
+
+    sf::FloatRect bounds_;
+    sf::Vector2f gravity_;
+    float restitution_ = 1.f;
+    bool body_collisions_ = true;
+    std::size_t pair_tests_ = 0;
+    std::size_t contacts_ = 0;
+};
+
+#endif // PHYSICSWORLD_H
@@ -1,13 +1,20 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
 
 #include <SFML/Window.hpp>
 #include <SFML/Graphics.hpp>
 
+#include "PhysicsWorld.h"
+
 class CustomRectangleShape : public sf::RectangleShape{
 private:
-    int Vspeed_ = 0;
-    int Hspeed_ = 0;
-    int Rspeed_ = 0;
+    float Vspeed_ = 0;
+    float Hspeed_ = 0;
+    float Rspeed_ = 0;
 
     int left;
     int right;
@@ -22,7 +29,7 @@ public:
         setSize(size);
     }
 
-    void setSpeed(int Vspeed,int Hspeed,int Rspeed){
+    void setSpeed(float Vspeed,float Hspeed,float Rspeed){
         Vspeed_ = Vspeed;
         Hspeed_ = Hspeed;
         Rspeed_ = Rspeed;
@@ -44,19 +51,19 @@ public:
         sf::FloatRect rectangle_bounds = getGlobalBounds();
 
         if(rectangle_bounds.top <= top){
-            Hspeed_ = abs(Hspeed_);
+            Hspeed_ = std::abs(Hspeed_);
         }
 
         if(rectangle_bounds.top + rectangle_bounds.height >= bottom){
-            Hspeed_ = abs(Hspeed_) * -1;
+            Hspeed_ = std::abs(Hspeed_) * -1;
         }
 
         if(rectangle_bounds.left <= left ){
-            Vspeed_ = abs(Vspeed_);
+            Vspeed_ = std::abs(Vspeed_);
         }
 
         if(rectangle_bounds.left + rectangle_bounds.width >= right){
-            Vspeed_ = abs(Vspeed_) * -1;
+            Vspeed_ = std::abs(Vspeed_) * -1;
         }
     }
 
@@ -82,7 +89,7 @@ public:
                     move(0, 0);
                 }
                 else{
-                    move(0, abs(Vspeed_)*elapsed.asSeconds()*(-1));
+                    move(0, std::abs(Vspeed_)*elapsed.asSeconds()*(-1));
                 }
             }
             if(sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
@@ -91,7 +98,7 @@ public:
                     move(0,0);
                 }
                 else{
-                    move(0, abs(Vspeed_)*elapsed.asSeconds());
+                    move(0, std::abs(Vspeed_)*elapsed.asSeconds());
                 }
             }
             if(sf::Keyboard::isKeyPressed(sf::Keyboard::Left))
@@ -100,7 +107,7 @@ public:
                     move(0,0);
                 }
                 else{
-                    move(abs(Hspeed_)*elapsed.asSeconds()*(-1), 0);
+                    move(std::abs(Hspeed_)*elapsed.asSeconds()*(-1), 0);
                 }
             }
             if(sf::Keyboard::isKeyPressed(sf::Keyboard::Right))
@@ -109,7 +116,7 @@ public:
                     move(0,0);
                 }
                 else{
-                    move(abs(Hspeed_)*elapsed.asSeconds(), 0);
+                    move(std::abs(Hspeed_)*elapsed.asSeconds(), 0);
                 }
             }
         }
@@ -129,19 +136,139 @@ bool fifarafa(bool &sibidibi, bool &fabadaba) {
     return false;
 }
 
-int main() {
+// count rectangles scattered over world_size, which becomes the bounds.
+void addSwarm(PhysicsWorld &world, std::size_t count, sf::Vector2f world_size, float min_size, float max_size,
+              float speed, std::mt19937 &random){
+    std::uniform_real_distribution<float> x(max_size, world_size.x - max_size);
+    std::uniform_real_distribution<float> y(max_size, world_size.y - max_size);
+    std::uniform_real_distribution<float> side(min_size, max_size);
+    std::uniform_real_distribution<float> velocity(-speed, speed);
+    std::uniform_real_distribution<float> spin(-90.f, 90.f);
+    world.reserve(world.size() + count);
+    for (std::size_t i = 0; i < count; i++){
+        world.addBody(sf::Vector2f(x(random), y(random)), sf::Vector2f(side(random), side(random)),
+                      sf::Vector2f(velocity(random), velocity(random)), spin(random));
+    }
+    world.setBounds(sf::FloatRect(0, 0, world_size.x, world_size.y));
+}
+
+// "--bench [max]": steps swarms of 1K, 10K, 100K... up to max rectangles
+// without a window and prints the time per step.
+int runBenchmark(std::size_t max_count){
+    const float dt = 1.f / 60.f;
+    const int steps = 300;
+    for (std::size_t count = 1000; count <= max_count; count *= 10){
+        // About 60 px of world per px of body, i.e. 1 in 60 covered
+        float side = std::sqrt(count * 36.f * 60.f);
+        PhysicsWorld world;
+        std::mt19937 random(4);
+        addSwarm(world, count, sf::Vector2f(side, side), 3.f, 9.f, 100.f, random);
+
+        world.step(dt); // the first step sorts from scratch
+        std::size_t pair_tests = 0;
+        std::size_t contacts = 0;
+        sf::Clock clock;
+        for (int step = 0; step < steps; step++){
+            world.step(dt);
+            pair_tests += world.pairTests();
+            contacts += world.contacts();
+        }
+        float ms = clock.getElapsedTime().asSeconds() * 1000.f / steps;
+        std::cout << count << " bodies: " << ms << " ms per step, "
+                  << pair_tests / steps << " pair tests, " << contacts / steps << " contacts" << std::endl;
+    }
+    return 0;
+}
+
+// "--swarm [count]": count rectangles bouncing around the window, all
+// drawn as one vertex array. The console shows the fps and step time.
+int runSwarm(sf::RenderWindow &window, std::size_t count){
+    sf::Vector2f window_size(window.getSize());
+    PhysicsWorld world;
+    std::mt19937 random(4);
+    addSwarm(world, count, window_size, 2.f, 6.f, 80.f, random);
+
+    sf::VertexArray quads(sf::Quads, count * 4);
+    std::uniform_int_distribution<int> shade(80, 255);
+    for (std::size_t i = 0; i < count; i++){
+        sf::Color color(shade(random), shade(random), shade(random));
+        for (int corner = 0; corner < 4; corner++){
+            quads[i * 4 + corner].color = color;
+        }
+    }
+
+    const float degrees = 3.14159265f / 180.f;
+    sf::Clock clock;
+    sf::Clock report_clock;
+    float step_ms = 0;
+    int frames = 0;
+    while (window.isOpen()){
+        sf::Time elapsed = clock.restart();
+
+        sf::Event event;
+        while (window.pollEvent(event)){
+            if (event.type == sf::Event::Closed)
+                window.close();
+        }
+
+        // A long frame (e.g. a dragged window) must not tunnel bodies
+        sf::Clock step_clock;
+        world.step(std::min(elapsed.asSeconds(), 1.f / 30.f));
+        step_ms += step_clock.getElapsedTime().asSeconds() * 1000.f;
+        frames++;
+        if (report_clock.getElapsedTime().asSeconds() >= 1.f){
+            std::cout << count << " bodies: " << frames / report_clock.restart().asSeconds() << " fps, "
+                      << step_ms / frames << " ms per step" << std::endl;
+            step_ms = 0;
+            frames = 0;
+        }
+
+        for (std::size_t i = 0; i < count; i++){
+            sf::Vector2f center = world.position(i);
+            sf::Vector2f half = world.bodySize(i) / 2.f;
+            float c = std::cos(world.angle(i) * degrees);
+            float s = std::sin(world.angle(i) * degrees);
+            sf::Vector2f along(c * half.x, s * half.x);
+            sf::Vector2f across(-s * half.y, c * half.y);
+            quads[i * 4].position = center - along - across;
+            quads[i * 4 + 1].position = center + along - across;
+            quads[i * 4 + 2].position = center + along + across;
+            quads[i * 4 + 3].position = center - along + across;
+        }
+
+        window.clear(sf::Color::Black);
+        window.draw(quads);
+        window.display();
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--bench"){
+        return runBenchmark(argc >= 3 ? std::strtoul(argv[2], nullptr, 10) : 100000);
+    }
     // create the window
 
     sf::RenderWindow window(sf::VideoMode(800, 600), "My window");
 
+    if (argc >= 2 && std::string(argv[1]) == "--swarm"){
+        window.setFramerateLimit(60);
+        return runSwarm(window, argc >= 3 ? std::strtoul(argv[2], nullptr, 10) : 20000);
+    }
+
     // create some shapes
     sf::CircleShape circle(50.0);
     circle.setPosition(100.0, 300.0);
     circle.setFillColor(sf::Color(100, 250, 50));
 
+    // Moved, spun and bounced off the window's edges by physics
     sf::RectangleShape rectangle(sf::Vector2f(120.0, 60.0));
-    rectangle.setPosition(500.0, 400.0);
+    rectangle.setOrigin(60.0, 30.0);
     rectangle.setFillColor(sf::Color(100, 50, 250));
+    PhysicsWorld physics;
+    physics.setBounds(sf::FloatRect(0, 0, window.getSize().x, window.getSize().y));
+    std::size_t rectangle_body = physics.addBody(sf::Vector2f(560.0, 430.0), rectangle.getSize(),
+                                                 sf::Vector2f(50.0, 200.0), 10.0);
 
     sf::ConvexShape triangle;
     triangle.setPointCount(3);
@@ -153,10 +280,6 @@ int main() {
     triangle.setPosition(600.0, 100.0);
     sf::Clock clock;
 
-    int rectangle_velocity_x = 50;
-    int rectangle_velocity_y = 200;
-    int rectangle_angular_velocity = 10;
-
     bool flag_y = false;
     bool flag_x = false;
 
@@ -173,32 +296,15 @@ int main() {
         float dt = elapsed.asSeconds();
 
 
-        sf::FloatRect rectangle_bounds = rectangle.getGlobalBounds();
         sf::FloatRect rectangle2_bounds = rectangle2.getGlobalBounds();
 
-        if(rectangle_bounds.top <= 0){
-            rectangle_velocity_y = abs(rectangle_velocity_y);
-            rectangle.setFillColor(sf::Color(rand() % 256, rand() % 256, rand() % 256));
-        }
-
-        if(rectangle_bounds.top + rectangle_bounds.height >= window.getSize().y){
-            rectangle_velocity_y = abs(rectangle_velocity_y) * -1;
+        physics.step(dt);
+        rectangle.setPosition(physics.position(rectangle_body));
+        rectangle.setRotation(physics.angle(rectangle_body));
+        if(physics.hitWall(rectangle_body)){
             rectangle.setFillColor(sf::Color(rand() % 256, rand() % 256, rand() % 256));
         }
 
-        if(rectangle_bounds.left <= 0 ){
-            rectangle_velocity_x = abs(rectangle_velocity_x);
-            rectangle.setFillColor(sf::Color(rand() % 256, rand() % 256, rand() % 256));
-        }
-
-        if(rectangle_bounds.left + rectangle_bounds.width >= window.getSize().x){
-            rectangle_velocity_x = abs(rectangle_velocity_x) * -1;
-            rectangle.setFillColor(sf::Color(rand() % 256, rand() % 256, rand() % 256));
-        }
-
-        rectangle.move(rectangle_velocity_x*dt,rectangle_velocity_y*dt);
-        rectangle.rotate(rectangle_angular_velocity*dt);
-
 
         // check all the window's events that were triggered since the last iteration of the loop
         sf::Vector2i mouse_pos = sf::Mouse::getPosition(window);
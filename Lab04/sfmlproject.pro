@@ -13,4 +13,8 @@ CONFIG(debug, debug|release){
 }
 
 SOURCES += \
+        PhysicsWorld.cpp \
         main.cpp
+
+HEADERS += \
+    PhysicsWorld.h
@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include "AabbBatch.h"
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+
+namespace {
+
+struct BoxSet {
+    std::vector<sf::FloatRect> rects;
+    std::vector<float> left;
+    std::vector<float> top;
+    std::vector<float> right;
+    std::vector<float> bottom;
+};
+
+BoxSet makeBoxes(std::size_t count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(0.0f, 10000.0f);
+    std::uniform_real_distribution<float> size(8.0f, 64.0f);
+
+    BoxSet set;
+    for (std::size_t i = 0; i < count; ++i) {
+        sf::FloatRect rect(position(rng), position(rng), size(rng), size(rng));
+        set.rects.push_back(rect);
+        set.left.push_back(rect.left);
+        set.top.push_back(rect.top);
+        set.right.push_back(rect.left + rect.width);
+        set.bottom.push_back(rect.top + rect.height);
+    }
+    return set;
+}
+
+// Checksum of one query's hit list. Each index is weighted by its place in
+// the list, so missing, extra or misordered hits all but surely change it.
+std::uint64_t hitSum(const std::vector<std::uint32_t>& hits, std::size_t count) {
+    std::uint64_t sum = count;
+    for (std::size_t h = 0; h < count; ++h) {
+        sum += std::uint64_t(hits[h]) * (h + 1);
+    }
+    return sum;
+}
+
+}
+
+// One rect against packed arrays of rects: the sf::FloatRect::intersects
+// loop the game used to run against each batch kernel the CPU supports.
+// Fails if a kernel finds other boxes than the loop.
+// Options: queries=<total box tests per size, in millions>
+int runAabbBenchmark(int argc, char* argv[]) {
+    const std::size_t sizes[] = { 1000, 100000, 1000000 };
+    const std::size_t testsPerSize = sizeOption(argc, argv, "queries", 200) * 1000000;
+    const AabbKernel kernels[] = { AABB_KERNEL_SCALAR, AABB_KERNEL_SSE2, AABB_KERNEL_AVX };
+
+    bool ok = true;
+    std::printf("aabb batch intersection, best kernel on this CPU: %s\n", aabbKernelName(bestAabbKernel()));
+
+    for (std::size_t count : sizes) {
+        BoxSet set = makeBoxes(count, 99);
+        AabbArrays boxes = { set.left.data(), set.top.data(), set.right.data(), set.bottom.data(), count };
+        std::vector<std::uint32_t> hits(count);
+        std::size_t queries = testsPerSize / count;
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> position(0.0f, 10000.0f);
+
+        std::vector<sf::FloatRect> queryRects;
+        for (std::size_t q = 0; q < queries; ++q) {
+            queryRects.push_back(sf::FloatRect(position(rng), position(rng), 32.0f, 32.0f));
+        }
+
+        std::uint64_t referenceSum = 0;
+        Stopwatch watch;
+        for (const auto& query : queryRects) {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                if (set.rects[i].intersects(query)) {
+                    hits[n++] = static_cast<std::uint32_t>(i);
+                }
+            }
+            referenceSum += hitSum(hits, n);
+        }
+        double referenceNs = watch.elapsedMs() * 1e6 / (static_cast<double>(queries) * count);
+        std::printf("  %8zu rects  FloatRect::intersects  %6.3f ns/rect\n", count, referenceNs);
+
+        for (AabbKernel kernel : kernels) {
+            // It would silently run the scalar kernel instead
+            if (!aabbKernelSupported(kernel)) {
+                std::printf("  %8zu rects  %-21s  not supported on this CPU\n", count, aabbKernelName(kernel));
+                continue;
+            }
+
+            std::uint64_t sum = 0;
+            Stopwatch kernelWatch;
+            for (const auto& query : queryRects) {
+                std::size_t n = intersectAabbs(kernel, query, boxes, hits.data());
+                sum += hitSum(hits, n);
+            }
+            double ns = kernelWatch.elapsedMs() * 1e6 / (static_cast<double>(queries) * count);
+            std::printf("  %8zu rects  %-21s  %6.3f ns/rect  %5.1fx%s\n", count, aabbKernelName(kernel), ns,
+                        ns > 0 ? referenceNs / ns : 0.0, sum == referenceSum ? "" : "  MISMATCH");
+            ok = ok && sum == referenceSum;
+        }
+    }
+    return ok ? 0 : 1;
+}
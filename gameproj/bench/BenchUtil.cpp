@@ -0,0 +1,72 @@
+#include "BenchUtil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::size_t index = static_cast<std::size_t>(std::round(p * (samples.size() - 1)));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void writeSyntheticLevel(const std::string& filePath, std::size_t tileCount, unsigned int seed) {
+    std::ofstream file(filePath);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> decoration(21, 38);
+    std::uniform_int_distribution<int> platform(0, 20);
+
+    // Square-ish world so the grid and culling code see a realistic layout.
+    int columns = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(tileCount))));
+    for (std::size_t i = 0; i < tileCount; ++i) {
+        int column = static_cast<int>(i % columns);
+        int row = static_cast<int>(i / columns);
+        int tileNumber;
+        if (row % 4 == 3) {
+            tileNumber = platform(rng);
+        } else if (i % 997 == 0) {
+            tileNumber = 39;
+        } else {
+            tileNumber = decoration(rng);
+        }
+        file << column * 32 << ' ' << row * 32 << ' ' << tileNumber << '\n';
+    }
+}
+
+WorldInput scriptedInput(std::size_t tick) {
+    const std::size_t ticksPerSecond = static_cast<std::size_t>(SIM_TICK_RATE);
+    std::size_t phase = tick % (4 * ticksPerSecond);
+
+    WorldInput input;
+    input.right = phase < 2 * ticksPerSecond;
+    input.left = !input.right;
+    input.jump = tick % (ticksPerSecond / 2) == 0;
+    return input;
+}
+
+std::size_t sizeOption(int argc, char* argv[], const std::string& name, std::size_t fallback) {
+    std::string prefix = name + "=";
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, prefix.size(), prefix) == 0) {
+            return static_cast<std::size_t>(std::strtoull(arg.c_str() + prefix.size(), nullptr, 10));
+        }
+    }
+    return fallback;
+}
+
+std::string stringOption(int argc, char* argv[], const std::string& name, const std::string& fallback) {
+    std::string prefix = name + "=";
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, prefix.size(), prefix) == 0) {
+            return arg.substr(prefix.size());
+        }
+    }
+    return fallback;
+}
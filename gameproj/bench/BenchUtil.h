@@ -0,0 +1,40 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "World.h"
+
+class Stopwatch {
+public:
+    Stopwatch() : m_start(std::chrono::steady_clock::now()) {}
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Value at fraction p (0-1) of the sorted samples; samples gets reordered.
+double percentile(std::vector<double>& samples, double p);
+
+// Writes a tile_data.txt style level of roughly tileCount tiles laid out on
+// a 32 px grid: rows of platforms, decorations above them and a few crowns.
+void writeSyntheticLevel(const std::string& filePath, std::size_t tileCount, unsigned int seed);
+
+// Fixed input script: run right for two seconds, back left for two, jump
+// twice a second. Only depends on the tick number so every run is the same.
+WorldInput scriptedInput(std::size_t tick);
+
+// Reads a size_t option of the form name=value, e.g. "tiles=1000000".
+std::size_t sizeOption(int argc, char* argv[], const std::string& name, std::size_t fallback);
+
+// Reads a string option of the form name=value, e.g. "level=tile_data.txt".
+std::string stringOption(int argc, char* argv[], const std::string& name, const std::string& fallback);
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,14 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Each benchmark gets the arguments following its name on the command line
+// and returns the process exit code.
+int runAabbBenchmark(int argc, char* argv[]);
+int runEcsBenchmark(int argc, char* argv[]);
+int runEditBenchmark(int argc, char* argv[]);
+int runGhostBenchmark(int argc, char* argv[]);
+int runLevelBenchmark(int argc, char* argv[]);
+int runReplayBenchmark(int argc, char* argv[]);
+int runTickBenchmark(int argc, char* argv[]);
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+#include "Components.h"
+#include "FrameArena.h"
+#include "GameConfig.h"
+#include "JobSystem.h"
+#include "Level.h"
+#include "Systems.h"
+#include "TileCollision.h"
+
+// Runs the entity systems over a crowd of animated bodies falling through a
+// synthetic level. All of them go through gravity, animation and movement;
+// every sweepEvery-th one is swept against the tiles like the player.
+// Options: entities=<count> ticks=<count> sweepEvery=<n> threads=<count>
+int runEcsBenchmark(int argc, char* argv[]) {
+    std::size_t entityCount = sizeOption(argc, argv, "entities", 100000);
+    std::size_t ticks = sizeOption(argc, argv, "ticks", 300);
+    std::size_t sweepEvery = sizeOption(argc, argv, "sweepEvery", 100);
+    unsigned threads = static_cast<unsigned>(sizeOption(argc, argv, "threads", 1));
+
+    const std::string path = "bench_ecs_level.txt";
+    writeSyntheticLevel(path, 10000, 4321);
+    Level level;
+    if (!level.loadText(path)) {
+        std::cerr << "Could not load " << path << std::endl;
+        return 1;
+    }
+    std::remove(path.c_str());
+
+    TileCollision collision;
+    collision.build(level.view(), sf::Vector2u(32, 32));
+
+    std::srand(1);
+    GameEntities entities;
+    for (std::size_t i = 0; i < entityCount; ++i) {
+        Entity entity = entities.create();
+
+        Transform transform;
+        transform.position = sf::Vector2f(static_cast<float>(std::rand() % GAME_WIDTH), static_cast<float>(std::rand() % GAME_HEIGHT));
+        transform.previous = transform.position;
+
+        Velocity velocity;
+        velocity.value = sf::Vector2f(static_cast<float>(std::rand() % 401) - 200.0f, 0);
+        velocity.gravity = 981.0f;
+
+        Collider collider;
+        collider.size = sf::Vector2f(32, 32);
+        collider.sweepTiles = sweepEvery > 0 && i % sweepEvery == 0;
+
+        Animation animation;
+        animation.frameSize = sf::Vector2i(32, 32);
+        animation.groundFrames = 2;
+        animation.airRow = 5;
+        animation.airFrames = 8;
+
+        entities.add(entity, transform);
+        entities.add(entity, velocity);
+        entities.add(entity, collider);
+        entities.add(entity, animation);
+    }
+
+    JobSystem jobs(threads);
+    FrameArena arena;
+    const float step = 1.0f / SIM_TICK_RATE;
+    double gravityMs = 0, animateMs = 0, sweepMs = 0, moveMs = 0;
+    std::vector<double> tickMs;
+    tickMs.reserve(ticks);
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        Stopwatch watch;
+        arena.reset();
+        Stopwatch phase;
+        applyGravity(entities, step);
+        gravityMs += phase.elapsedMs();
+
+        phase = Stopwatch();
+        animate(entities, step);
+        animateMs += phase.elapsedMs();
+
+        phase = Stopwatch();
+        sweepTiles(entities, collision, step, arena);
+        sweepMs += phase.elapsedMs();
+
+        phase = Stopwatch();
+        moveBodies(entities, step, &jobs);
+        moveMs += phase.elapsedMs();
+        tickMs.push_back(watch.elapsedMs());
+    }
+
+    std::printf("entity systems, %zu entities (%zu swept), %zu ticks, %u threads\n",
+                entities.getEntityCount(), sweepEvery > 0 ? (entityCount + sweepEvery - 1) / sweepEvery : 0, ticks, jobs.getThreadCount());
+    std::printf("  gravity %.3f ms  animate %.3f ms  sweep %.3f ms  move %.3f ms per tick\n",
+                gravityMs / ticks, animateMs / ticks, sweepMs / ticks, moveMs / ticks);
+    std::printf("  total p50 %.3f ms  p99 %.3f ms per tick\n", percentile(tickMs, 0.5), percentile(tickMs, 0.99));
+    return 0;
+}
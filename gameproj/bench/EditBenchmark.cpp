@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+#include "FrameArena.h"
+#include "Level.h"
+#include "TileMap.h"
+#include "TileTypes.h"
+
+namespace {
+
+const int TILE = 32;
+
+// What the level should hold after the edits: the tile at each corner.
+typedef std::map<std::pair<int, int>, int> TileModel;
+
+bool rectLess(const sf::FloatRect& a, const sf::FloatRect& b) {
+    return a.top != b.top ? a.top < b.top : a.left < b.left;
+}
+
+// The model's solid (or goal) tiles overlapping area, sorted.
+std::vector<sf::FloatRect> expectedRects(const TileModel& model, const sf::FloatRect& area, bool goal) {
+    std::vector<sf::FloatRect> rects;
+    for (const auto& tile : model) {
+        TileType type = tileType(tile.second);
+        if (goal ? !type.isGoal() : !type.isSolid()) {
+            continue;
+        }
+        sf::FloatRect rect(tile.first.first, tile.first.second, TILE, TILE);
+        if (rect.intersects(area)) {
+            rects.push_back(rect);
+        }
+    }
+    std::sort(rects.begin(), rects.end(), rectLess);
+    return rects;
+}
+
+std::vector<sf::FloatRect> sorted(const FrameVector<sf::FloatRect>& found) {
+    std::vector<sf::FloatRect> rects(found.begin(), found.end());
+    std::sort(rects.begin(), rects.end(), rectLess);
+    return rects;
+}
+
+}
+
+// Random setTile/removeTile edits on a synthetic level, timed, then area
+// queries on the map's collision checked against what the edits should
+// have left. Also fails if edits keep growing the collision rect arrays
+// or a tile number outside the tileset gets in.
+// Options: tiles=<count> edits=<count> queries=<count>
+int runEditBenchmark(int argc, char* argv[]) {
+    std::size_t tileCount = sizeOption(argc, argv, "tiles", 10000);
+    std::size_t edits = sizeOption(argc, argv, "edits", 100000);
+    std::size_t queries = sizeOption(argc, argv, "queries", 2000);
+
+    const std::string path = "bench_edit_level.txt";
+    writeSyntheticLevel(path, tileCount, 2468);
+    Level level;
+    if (!level.loadText(path)) {
+        std::cerr << "Could not load " << path << std::endl;
+        return 1;
+    }
+    std::remove(path.c_str());
+
+    // Only the region's size matters without a window: 10 x 4 tiles, the
+    // numbers writeSyntheticLevel uses
+    const int tilesetTiles = 40;
+    TileMap map;
+    if (!map.prepare(std::make_shared<sf::Texture>(), sf::Vector2u(TILE, TILE), level.view(),
+                     sf::IntRect(0, 0, 10 * TILE, 4 * TILE))) {
+        std::cerr << "Could not prepare the tile map" << std::endl;
+        return 1;
+    }
+
+    const LevelView& view = level.view();
+    TileModel model;
+    int maxX = 0;
+    int maxY = 0;
+    for (std::size_t i = 0; i < view.tileCount; ++i) {
+        model[std::make_pair(view.x[i], view.y[i])] = view.tileNumber[i];
+        maxX = std::max(maxX, view.x[i]);
+        maxY = std::max(maxY, view.y[i]);
+    }
+
+    bool ok = true;
+    if (map.setTile(sf::Vector2i(0, 0), tilesetTiles) || map.setTile(sf::Vector2i(0, 0), -1)) {
+        std::cerr << "setTile took a tile number outside the tileset" << std::endl;
+        ok = false;
+    }
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> column(0, maxX / TILE);
+    std::uniform_int_distribution<int> row(0, maxY / TILE);
+    std::uniform_int_distribution<int> tileNumber(0, tilesetTiles - 1);
+    std::uniform_int_distribution<int> action(0, 3);
+
+    std::size_t rectSlots = map.getCollision().getCollisionRects().size();
+    std::size_t peakSolid = rectSlots;
+    std::size_t solid = rectSlots;
+    Stopwatch editWatch;
+    for (std::size_t e = 0; e < edits; ++e) {
+        sf::Vector2i position(column(rng) * TILE, row(rng) * TILE);
+        auto key = std::make_pair(position.x, position.y);
+        auto tile = model.find(key);
+        bool wasSolid = tile != model.end() && tileType(tile->second).isSolid();
+
+        if (action(rng) == 0) {
+            bool removed = map.removeTile(position);
+            if (removed != (tile != model.end())) {
+                std::cerr << "removeTile at (" << position.x << ", " << position.y << ") returned " << removed << std::endl;
+                ok = false;
+            }
+            if (tile != model.end()) {
+                model.erase(tile);
+            }
+            solid -= wasSolid ? 1 : 0;
+        } else {
+            int number = tileNumber(rng);
+            if (!map.setTile(position, number)) {
+                std::cerr << "setTile at (" << position.x << ", " << position.y << ") failed" << std::endl;
+                ok = false;
+            }
+            model[key] = number;
+            solid += (tileType(number).isSolid() ? 1 : 0) - (wasSolid ? 1 : 0);
+        }
+        peakSolid = std::max(peakSolid, solid);
+    }
+    double editUs = editWatch.elapsedMs() * 1000.0 / std::max<std::size_t>(edits, 1);
+
+    // Removed slots are reused, so there are never more than the most
+    // solid tiles there have been at once
+    rectSlots = map.getCollision().getCollisionRects().size();
+    if (rectSlots > peakSolid) {
+        std::cerr << rectSlots << " collision rects kept for at most " << peakSolid << " solid tiles" << std::endl;
+        ok = false;
+    }
+
+    FrameArena arena;
+    std::uniform_int_distribution<int> areaX(-TILE, maxX + TILE);
+    std::uniform_int_distribution<int> areaY(-TILE, maxY + TILE);
+    std::uniform_int_distribution<int> areaSize(1, 8 * TILE);
+    std::size_t mismatches = 0;
+    Stopwatch queryWatch;
+    for (std::size_t q = 0; q < queries; ++q) {
+        arena.reset();
+        sf::FloatRect area(areaX(rng), areaY(rng), areaSize(rng), areaSize(rng));
+        if (sorted(map.getCollision().queryCollisionRects(area, arena)) != expectedRects(model, area, false) ||
+            sorted(map.getCollision().queryCrownRects(area, arena)) != expectedRects(model, area, true)) {
+            mismatches++;
+        }
+    }
+    double queryMs = queryWatch.elapsedMs();
+    if (mismatches > 0) {
+        std::cerr << mismatches << " of " << queries << " queries found other rects than the edits left" << std::endl;
+        ok = false;
+    }
+
+    std::printf("tile edits, %zu tiles, %zu edits, %zu checked queries\n", view.tileCount, edits, queries);
+    std::printf("  %8.3f us per edit  %zu collision rects for %zu solid tiles (peak %zu)  %.1f ms checking  %s\n",
+                editUs, rectSlots, solid, peakSolid, queryMs, ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
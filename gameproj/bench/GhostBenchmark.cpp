@@ -0,0 +1,53 @@
+#include <cstdio>
+#include <vector>
+
+#include "Attacker.h"
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+#include "GameConfig.h"
+#include "Player.h"
+#include "Random.h"
+#include "Systems.h"
+
+// Ghost spawning, moveBodies and Attacker::update with a shortened spawn
+// interval, sized so that about `live` ghosts are on screen once spawning
+// and despawning balance out.
+// Options: live=<count> ticks=<count>
+int runGhostBenchmark(int argc, char* argv[]) {
+    std::size_t live = sizeOption(argc, argv, "live", 40000);
+    std::size_t ticks = sizeOption(argc, argv, "ticks", 3000);
+
+    // A ghost falls GAME_HEIGHT pixels at 200 px/s before it despawns.
+    const float lifetime = GAME_HEIGHT / 200.0f;
+    const float step = 1.0f / SIM_TICK_RATE;
+    const std::size_t warmupTicks = static_cast<std::size_t>(lifetime * SIM_TICK_RATE);
+
+    GameEntities entities;
+    Random random(1);
+    Player player(entities);
+    Attacker attacker(entities, random, HARD, WINDOW_WIDTH);
+    attacker.setSpawnInterval(lifetime / live);
+
+    for (std::size_t tick = 0; tick < warmupTicks; ++tick) {
+        attacker.spawn(step);
+        moveBodies(entities, step);
+        attacker.update(player);
+    }
+
+    std::vector<double> tickMs;
+    tickMs.reserve(ticks);
+    Stopwatch total;
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        Stopwatch watch;
+        attacker.spawn(step);
+        moveBodies(entities, step);
+        attacker.update(player);
+        tickMs.push_back(watch.elapsedMs());
+    }
+    double totalMs = total.elapsedMs();
+
+    std::printf("ghost update, ~%zu live (%zu at end), %zu ticks\n", live, attacker.getGhostCount(), ticks);
+    std::printf("  mean %.3f ms  p50 %.3f ms  p99 %.3f ms per tick\n",
+                totalMs / ticks, percentile(tickMs, 0.5), percentile(tickMs, 0.99));
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+#include "Level.h"
+
+namespace {
+
+// Reads every tile so the mapped pages are actually faulted in; otherwise
+// the binary path would only be timing mmap itself.
+std::int64_t touch(const LevelView& view) {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < view.tileCount; ++i) {
+        sum += view.x[i] + view.y[i] + view.tileNumber[i];
+    }
+    for (std::size_t i = 0; i < view.collisionCount; ++i) {
+        sum += view.collision[i];
+    }
+    return sum;
+}
+
+}
+
+// Startup cost of the text parser against the mapped binary level.
+// Options: tiles=<count> runs=<count>
+int runLevelBenchmark(int argc, char* argv[]) {
+    std::size_t tileCount = sizeOption(argc, argv, "tiles", 1000000);
+    std::size_t runs = sizeOption(argc, argv, "runs", 5);
+
+    const std::string textPath = "bench_level.txt";
+    const std::string binaryPath = "bench_level.lvl";
+
+    writeSyntheticLevel(textPath, tileCount, 1234);
+    {
+        Level level;
+        if (!level.loadText(textPath) || !level.saveBinary(binaryPath)) {
+            std::cerr << "Could not prepare synthetic level" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<double> textMs;
+    std::vector<double> binaryMs;
+    std::int64_t textSum = 0;
+    std::int64_t binarySum = 0;
+
+    for (std::size_t run = 0; run < runs; ++run) {
+        {
+            Stopwatch watch;
+            Level level;
+            level.loadText(textPath);
+            textSum = touch(level.view());
+            textMs.push_back(watch.elapsedMs());
+        }
+        {
+            Stopwatch watch;
+            Level level;
+            level.loadBinary(binaryPath);
+            binarySum = touch(level.view());
+            binaryMs.push_back(watch.elapsedMs());
+        }
+    }
+
+    if (textSum != binarySum) {
+        std::cerr << "Text and binary levels differ" << std::endl;
+        return 1;
+    }
+
+    double text = percentile(textMs, 0.5);
+    double binary = percentile(binaryMs, 0.5);
+    std::printf("level load, %zu tiles, median of %zu runs\n", tileCount, runs);
+    std::printf("  text   %10.2f ms\n", text);
+    std::printf("  binary %10.2f ms  (%.1fx)\n", binary, binary > 0 ? text / binary : 0.0);
+
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+#include "GameConfig.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "Level.h"
+#include "TileCollision.h"
+#include "World.h"
+
+namespace {
+
+struct RoundEnd {
+    std::size_t ticks = 0;
+    sf::Vector2f position;
+    std::size_t ghosts = 0;
+
+    bool operator==(const RoundEnd& other) const {
+        return ticks == other.ticks && position == other.position && ghosts == other.ghosts;
+    }
+};
+
+// Plays the tick benchmark's script as one round, recording it, until the
+// player reaches a crown, falls off the level or ticks run out.
+RoundEnd recordScript(World& world, std::size_t ticks, Difficulty difficulty, InputRecording& recording) {
+    const float step = 1.0f / SIM_TICK_RATE;
+    const std::uint64_t seed = 1;
+    world.start(difficulty, seed);
+    recording.begin(difficulty, seed, step);
+
+    RoundEnd end;
+    for (; end.ticks < ticks; ++end.ticks) {
+        WorldInput input = scriptedInput(end.ticks);
+        recording.record(input);
+        if (world.tick(step, input) || world.getPlayer().getPosition().y > 2 * GAME_HEIGHT) {
+            end.ticks++;
+            break;
+        }
+    }
+    end.position = world.getPlayer().getPosition();
+    end.ghosts = world.getAttacker().getGhostCount();
+    return end;
+}
+
+// Same as replay(), timing every tick.
+RoundEnd timedReplay(World& world, const InputRecording& recording, std::vector<double>& tickMs) {
+    world.start(recording.getDifficulty(), recording.getSeed());
+
+    RoundEnd end;
+    for (; end.ticks < recording.getTickCount(); ++end.ticks) {
+        Stopwatch watch;
+        bool won = world.tick(recording.getStep(), recording.getInput(end.ticks));
+        tickMs.push_back(watch.elapsedMs());
+        if (won) {
+            end.ticks++;
+            break;
+        }
+    }
+    end.position = world.getPlayer().getPosition();
+    end.ghosts = world.getAttacker().getGhostCount();
+    return end;
+}
+
+}
+
+// Replays a recorded round (F5 in the game) as a performance fixture: per
+// tick timings plus the end state, which has to stay the same from build
+// to build. Without file= the tick benchmark's script is recorded first,
+// saved and loaded back, and the replay must end exactly like the recording.
+// Options: file=<replay.inp> level=<tile_data.txt> threads=<count>
+//          ticks=<count, for the script> repeat=<count>
+int runReplayBenchmark(int argc, char* argv[]) {
+    std::string filePath = stringOption(argc, argv, "file", "");
+    std::string levelPath = stringOption(argc, argv, "level", "../proje3/assets/tile_data.txt");
+    std::size_t threads = sizeOption(argc, argv, "threads", 1);
+    std::size_t scriptTicks = sizeOption(argc, argv, "ticks", 20000);
+    std::size_t repeat = sizeOption(argc, argv, "repeat", 5);
+
+    Level level;
+    if (!level.loadText(levelPath)) {
+        std::cerr << "Could not load " << levelPath << std::endl;
+        return 1;
+    }
+    TileCollision collision;
+    collision.build(level.view(), sf::Vector2u(32, 32));
+
+    JobSystem jobs(static_cast<unsigned>(threads));
+    World world(collision);
+    world.setJobSystem(&jobs);
+
+    InputRecording recording;
+    RoundEnd expected;
+    bool checkExpected = filePath.empty();
+    if (checkExpected) {
+        InputRecording recorded;
+        expected = recordScript(world, scriptTicks, HARD, recorded);
+        filePath = "bench_replay.inp";
+        if (!recorded.save(filePath)) {
+            std::cerr << "Could not write " << filePath << std::endl;
+            return 1;
+        }
+    }
+    if (!recording.load(filePath)) {
+        std::cerr << "Could not load recording " << filePath << std::endl;
+        return 1;
+    }
+    if (checkExpected) {
+        std::remove(filePath.c_str());
+    }
+
+    std::printf("replay of %zu ticks, %zu threads, %zu times\n", recording.getTickCount(), threads, repeat);
+
+    bool ok = true;
+    std::vector<double> tickMs;
+    tickMs.reserve(recording.getTickCount() * repeat);
+    RoundEnd first;
+    Stopwatch total;
+    for (std::size_t run = 0; run < repeat; ++run) {
+        RoundEnd end = timedReplay(world, recording, tickMs);
+        if (run == 0) {
+            first = end;
+        } else if (!(end == first)) {
+            std::cerr << "Replay " << run << " ended differently from the first" << std::endl;
+            ok = false;
+        }
+    }
+    double totalMs = total.elapsedMs();
+
+    if (checkExpected && !(first == expected)) {
+        std::fprintf(stderr, "Replay ended at tick %zu (%.1f, %.1f), recording at tick %zu (%.1f, %.1f)\n",
+                     first.ticks, first.position.x, first.position.y, expected.ticks, expected.position.x, expected.position.y);
+        ok = false;
+    }
+
+    std::printf("  %10.0f ticks/s  p50 %7.2f us  p99 %7.2f us  end tick %zu (%.1f, %.1f)  ghosts %zu  %s\n",
+                tickMs.size() / (totalMs / 1000.0), percentile(tickMs, 0.5) * 1000.0, percentile(tickMs, 0.99) * 1000.0,
+                first.ticks, first.position.x, first.position.y, first.ghosts, ok ? "deterministic" : "MISMATCH");
+    return ok ? 0 : 1;
+}
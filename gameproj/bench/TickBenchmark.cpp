@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AllocationTracker.h"
+#include "BenchUtil.h"
+#include "Benchmarks.h"
+#include "GameConfig.h"
+#include "JobSystem.h"
+#include "Level.h"
+#include "TileCollision.h"
+#include "World.h"
+
+namespace {
+
+// Where a run ended up. Runs of one level and input differ only in speed.
+struct ScenarioResult {
+    bool loaded = false;
+    sf::Vector2f position;
+    std::size_t ghosts = 0;
+    std::size_t wins = 0;
+    std::size_t falls = 0;
+
+    bool operator==(const ScenarioResult& other) const {
+        return loaded == other.loaded && position == other.position && ghosts == other.ghosts &&
+               wins == other.wins && falls == other.falls;
+    }
+};
+
+// crowd > 0 shortens the ghost spawn interval so that about that many
+// ghosts are alive at once.
+ScenarioResult runScenario(const std::string& name, const std::string& levelPath, std::size_t ticks, Difficulty difficulty,
+                 std::size_t crowd = 0, JobSystem* jobs = nullptr) {
+    Level level;
+    if (!level.loadText(levelPath)) {
+        std::cerr << "Could not load " << levelPath << std::endl;
+        return ScenarioResult();
+    }
+
+    TileCollision collision;
+    collision.build(level.view(), sf::Vector2u(32, 32));
+
+    World world(collision);
+    world.setJobSystem(jobs);
+    auto restart = [&]() {
+        world.start(difficulty, 1);
+        if (crowd > 0) {
+            // A ghost falls GAME_HEIGHT pixels at 200 px/s before it despawns.
+            world.getAttacker().setSpawnInterval(GAME_HEIGHT / 200.0f / crowd);
+        }
+    };
+    restart();
+
+    const float step = 1.0f / SIM_TICK_RATE;
+    std::vector<double> tickMs;
+    tickMs.reserve(ticks);
+    std::size_t wins = 0;
+    std::size_t falls = 0;
+
+    std::size_t allocationsBefore = allocationCount();
+    Stopwatch total;
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        Stopwatch watch;
+        if (world.tick(step, scriptedInput(tick))) {
+            wins++;
+            restart();
+        } else if (world.getPlayer().getPosition().y > 2 * GAME_HEIGHT) {
+            // The script can walk off the level; respawn rather than time
+            // an endless fall with nothing to collide with.
+            falls++;
+            restart();
+        }
+        tickMs.push_back(watch.elapsedMs());
+    }
+    double totalMs = total.elapsedMs();
+    // tickMs was reserved up front, so everything counted here is the world's.
+    std::size_t allocations = allocationCount() - allocationsBefore;
+
+    sf::Vector2f position = world.getPlayer().getPosition();
+    std::printf("%-22s %8zu tiles  %10.0f ticks/s  p50 %7.2f us  p99 %7.2f us  %8.2f allocs/tick  wins %zu  falls %zu  end (%.1f, %.1f)",
+                name.c_str(), level.view().tileCount, ticks / (totalMs / 1000.0),
+                percentile(tickMs, 0.5) * 1000.0, percentile(tickMs, 0.99) * 1000.0,
+                static_cast<double>(allocations) / ticks, wins, falls, position.x, position.y);
+    if (crowd > 0) {
+        std::printf("  ghosts %zu", world.getAttacker().getGhostCount());
+    }
+    std::printf("\n");
+
+    ScenarioResult result;
+    result.loaded = true;
+    result.position = position;
+    result.ghosts = world.getAttacker().getGhostCount();
+    result.wins = wins;
+    result.falls = falls;
+    return result;
+}
+
+}
+
+// Headless simulation throughput with a scripted input stream.
+// The crowd runs repeat one level with ~crowd ghosts on 1, 2, 4 and 8
+// threads. The merge is deterministic, so each end state must match the
+// 1 thread run; a difference fails the benchmark.
+// Options: ticks=<count> hard=<0|1> level=<tile_data.txt>
+//          crowd=<ghosts, 0 skips> crowdTicks=<count>
+int runTickBenchmark(int argc, char* argv[]) {
+    std::size_t ticks = sizeOption(argc, argv, "ticks", 100000);
+    std::size_t crowd = sizeOption(argc, argv, "crowd", 40000);
+    std::size_t crowdTicks = sizeOption(argc, argv, "crowdTicks", 3000);
+    Difficulty difficulty = sizeOption(argc, argv, "hard", 1) ? HARD : NORMAL;
+
+    std::string levelPath = stringOption(argc, argv, "level", "../proje3/assets/tile_data.txt");
+
+    std::printf("headless world tick, %zu ticks at %.0f Hz\n", ticks, SIM_TICK_RATE);
+
+    bool ok = true;
+    if (std::ifstream(levelPath)) {
+        ok = runScenario("tile_data.txt", levelPath, ticks, difficulty).loaded && ok;
+    } else {
+        std::cerr << "Skipping " << levelPath << " (not found)" << std::endl;
+    }
+
+    const std::string path = "bench_tick_level.txt";
+    const std::size_t syntheticSizes[] = { 10000, 1000000 };
+    for (std::size_t tiles : syntheticSizes) {
+        writeSyntheticLevel(path, tiles, 4321);
+        ok = runScenario("synthetic", path, ticks, difficulty).loaded && ok;
+    }
+
+    if (crowd > 0) {
+        writeSyntheticLevel(path, 10000, 4321);
+        const unsigned threadCounts[] = { 1, 2, 4, 8 };
+        ScenarioResult serial;
+        for (unsigned threads : threadCounts) {
+            JobSystem jobs(threads);
+            std::string name = "crowd, " + std::to_string(threads) + " threads";
+            ScenarioResult result = runScenario(name, path, crowdTicks, difficulty, crowd, &jobs);
+            ok = result.loaded && ok;
+            if (threads == 1) {
+                serial = result;
+            } else if (!(result == serial)) {
+                std::printf("  MISMATCH: %u threads ended elsewhere than 1 thread\n", threads);
+                ok = false;
+            }
+        }
+    }
+    std::remove(path.c_str());
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += "C:/SFML-2.5.1/include"
+INCLUDEPATH += ../proje3
+
+LIBS += -L"C:/SFML-2.5.1/lib"
+CONFIG(debug, debug|release){
+    LIBS += -lsfml-audio-d -lsfml-graphics-d -lsfml-network-d -lsfml-system-d -lsfml-window-d
+} else {
+    LIBS += -lsfml-audio -lsfml-graphics -lsfml-network -lsfml-system -lsfml-window
+}
+
+SOURCES += \
+        ../proje3/AabbBatch.cpp \
+        ../proje3/AllocationTracker.cpp \
+        ../proje3/Attacker.cpp \
+        ../proje3/FrameArena.cpp \
+        ../proje3/FrameProfiler.cpp \
+        ../proje3/InputRecording.cpp \
+        ../proje3/JobSystem.cpp \
+        ../proje3/Level.cpp \
+        ../proje3/MappedFile.cpp \
+        ../proje3/Player.cpp \
+        ../proje3/SpatialGrid.cpp \
+        ../proje3/SpriteBatch.cpp \
+        ../proje3/Systems.cpp \
+        ../proje3/TileCollision.cpp \
+        ../proje3/TileMap.cpp \
+        ../proje3/World.cpp \
+        AabbBenchmark.cpp \
+        BenchUtil.cpp \
+        EcsBenchmark.cpp \
+        EditBenchmark.cpp \
+        GhostBenchmark.cpp \
+        LevelBenchmark.cpp \
+        ReplayBenchmark.cpp \
+        TickBenchmark.cpp \
+        main.cpp
+
+HEADERS += \
+    ../proje3/AabbBatch.h \
+    ../proje3/AllocationTracker.h \
+    ../proje3/Attacker.h \
+    ../proje3/Components.h \
+    ../proje3/EntityStore.h \
+    ../proje3/FrameArena.h \
+    ../proje3/FrameProfiler.h \
+    ../proje3/GameConfig.h \
+    ../proje3/InputRecording.h \
+    ../proje3/JobSystem.h \
+    ../proje3/Level.h \
+    ../proje3/MappedFile.h \
+    ../proje3/Player.h \
+    ../proje3/Random.h \
+    ../proje3/SpatialGrid.h \
+    ../proje3/SpriteBatch.h \
+    ../proje3/Systems.h \
+    ../proje3/TileCollision.h \
+    ../proje3/TileMap.h \
+    ../proje3/TileTypes.h \
+    ../proje3/World.h \
+    BenchUtil.h \
+    Benchmarks.h
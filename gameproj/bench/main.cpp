@@ -0,0 +1,39 @@
+#include <cstring>
+#include <iostream>
+
+#include "Benchmarks.h"
+
+struct BenchmarkEntry {
+    const char* name;
+    int (*run)(int argc, char* argv[]);
+};
+
+const BenchmarkEntry BENCHMARKS[] = {
+    { "aabb", runAabbBenchmark },
+    { "ecs", runEcsBenchmark },
+    { "edit", runEditBenchmark },
+    { "ghosts", runGhostBenchmark },
+    { "level", runLevelBenchmark },
+    { "replay", runReplayBenchmark },
+    { "tick", runTickBenchmark },
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: bench <benchmark> [name=value ...]" << std::endl << "Benchmarks:";
+        for (const auto& entry : BENCHMARKS) {
+            std::cerr << " " << entry.name;
+        }
+        std::cerr << std::endl;
+        return 1;
+    }
+
+    for (const auto& entry : BENCHMARKS) {
+        if (std::strcmp(argv[1], entry.name) == 0) {
+            return entry.run(argc - 2, argv + 2);
+        }
+    }
+
+    std::cerr << "Unknown benchmark " << argv[1] << std::endl;
+    return 1;
+}
@@ -0,0 +1,18 @@
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../proje3
+
+SOURCES += \
+        ../proje3/Level.cpp \
+        ../proje3/LevelChunks.cpp \
+        ../proje3/MappedFile.cpp \
+        main.cpp
+
+HEADERS += \
+    ../proje3/Level.h \
+    ../proje3/LevelChunks.h \
+    ../proje3/MappedFile.h \
+    ../proje3/TileTypes.h
@@ -0,0 +1,91 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Level.h"
+#include "LevelChunks.h"
+
+namespace {
+
+// levelconv --chunks <pixels> tile_data.txt world: splits the level into
+// square chunks the game streams in around the camera, see LevelChunks.
+int writeChunks(const std::string& chunkSize, const std::string& input, const std::string& directory) {
+    int size = std::atoi(chunkSize.c_str());
+    if (size <= 0) {
+        std::cerr << "Bad chunk size " << chunkSize << std::endl;
+        return 1;
+    }
+
+    Level level;
+    if (!level.loadText(input)) {
+        std::cerr << "Could not read " << input << std::endl;
+        return 1;
+    }
+
+    if (!LevelChunks::write(level.view(), size, directory)) {
+        return 1;
+    }
+
+    LevelChunks check;
+    if (!check.open(directory)) {
+        std::cerr << "Verification of " << directory << " failed" << std::endl;
+        return 1;
+    }
+
+    int chunks = 0;
+    for (int y = 0; y < check.getRows(); ++y) {
+        for (int x = 0; x < check.getCols(); ++x) {
+            ChunkCoord chunk;
+            chunk.x = check.getFirst().x + x;
+            chunk.y = check.getFirst().y + y;
+            chunks += check.hasChunk(chunk) ? 1 : 0;
+        }
+    }
+    std::cout << input << " -> " << directory << ": "
+              << level.view().tileCount << " tiles in " << chunks << " chunks of "
+              << size << " px" << std::endl;
+    return 0;
+}
+
+}
+
+// Converts a tile_data.txt style level into the binary format the game maps
+// at startup: levelconv tile_data.txt tile_data.lvl
+int main(int argc, char* argv[]) {
+    if (argc == 5 && std::string(argv[1]) == "--chunks") {
+        return writeChunks(argv[2], argv[3], argv[4]);
+    }
+
+    if (argc != 3) {
+        std::cerr << "Usage: levelconv <input.txt> <output.lvl>" << std::endl;
+        std::cerr << "       levelconv --chunks <pixels> <input.txt> <directory>" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+
+    Level level;
+    if (!level.loadText(input)) {
+        std::cerr << "Could not read " << input << std::endl;
+        return 1;
+    }
+
+    if (!level.saveBinary(output)) {
+        std::cerr << "Could not write " << output << std::endl;
+        return 1;
+    }
+
+    // Read the result back so a broken file never reaches the game.
+    Level check;
+    if (!check.loadBinary(output) || check.view().tileCount != level.view().tileCount) {
+        std::cerr << "Verification of " << output << " failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << input << " -> " << output << ": "
+              << level.view().tileCount << " tiles, "
+              << level.view().collisionCount << " solid, "
+              << level.view().crownCount << " crowns" << std::endl;
+    return 0;
+}
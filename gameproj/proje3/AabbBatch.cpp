@@ -0,0 +1,158 @@
+#include "AabbBatch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AABB_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Batches smaller than this always take the scalar path.
+const std::size_t SMALL_BATCH = 32;
+
+typedef std::size_t (*KernelFunction)(float, float, float, float, const AabbArrays&, std::uint32_t*);
+
+std::size_t scalarTail(float left, float top, float right, float bottom, const AabbArrays& boxes, std::size_t i, std::size_t n, std::uint32_t* hits) {
+    // Branch free: always store the index and only advance past it on a
+    // hit. hits has room for boxes.count entries, so this never overruns.
+    for (; i < boxes.count; ++i) {
+        bool hit = (boxes.left[i] < right) & (left < boxes.right[i]) & (boxes.top[i] < bottom) & (top < boxes.bottom[i]);
+        hits[n] = static_cast<std::uint32_t>(i);
+        n += hit;
+    }
+    return n;
+}
+
+std::size_t intersectScalar(float left, float top, float right, float bottom, const AabbArrays& boxes, std::uint32_t* hits) {
+    return scalarTail(left, top, right, bottom, boxes, 0, 0, hits);
+}
+
+#ifdef AABB_HAVE_X86
+
+// Hits are rare, so the mask is usually zero and the bit loop is skipped.
+inline std::size_t appendHits(unsigned int mask, std::size_t base, std::size_t n, std::uint32_t* hits) {
+    while (mask) {
+        hits[n++] = static_cast<std::uint32_t>(base + __builtin_ctz(mask));
+        mask &= mask - 1;
+    }
+    return n;
+}
+
+__attribute__((target("sse2")))
+std::size_t intersectSse2(float left, float top, float right, float bottom, const AabbArrays& boxes, std::uint32_t* hits) {
+    const __m128 l = _mm_set1_ps(left);
+    const __m128 t = _mm_set1_ps(top);
+    const __m128 r = _mm_set1_ps(right);
+    const __m128 b = _mm_set1_ps(bottom);
+
+    std::size_t n = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= boxes.count; i += 4) {
+        __m128 hit = _mm_and_ps(
+            _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(boxes.left + i), r), _mm_cmplt_ps(l, _mm_loadu_ps(boxes.right + i))),
+            _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(boxes.top + i), b), _mm_cmplt_ps(t, _mm_loadu_ps(boxes.bottom + i))));
+        n = appendHits(static_cast<unsigned int>(_mm_movemask_ps(hit)), i, n, hits);
+    }
+    return scalarTail(left, top, right, bottom, boxes, i, n, hits);
+}
+
+__attribute__((target("avx")))
+std::size_t intersectAvx(float left, float top, float right, float bottom, const AabbArrays& boxes, std::uint32_t* hits) {
+    const __m256 l = _mm256_set1_ps(left);
+    const __m256 t = _mm256_set1_ps(top);
+    const __m256 r = _mm256_set1_ps(right);
+    const __m256 b = _mm256_set1_ps(bottom);
+
+    std::size_t n = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= boxes.count; i += 8) {
+        __m256 hit = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(boxes.left + i), r, _CMP_LT_OQ), _mm256_cmp_ps(l, _mm256_loadu_ps(boxes.right + i), _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(boxes.top + i), b, _CMP_LT_OQ), _mm256_cmp_ps(t, _mm256_loadu_ps(boxes.bottom + i), _CMP_LT_OQ)));
+        n = appendHits(static_cast<unsigned int>(_mm256_movemask_ps(hit)), i, n, hits);
+    }
+    return scalarTail(left, top, right, bottom, boxes, i, n, hits);
+}
+
+#endif
+
+bool kernelSupported(AabbKernel kernel) {
+#ifdef AABB_HAVE_X86
+    __builtin_cpu_init();
+    switch (kernel) {
+    case AABB_KERNEL_AVX:
+        return __builtin_cpu_supports("avx");
+    case AABB_KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    default:
+        return true;
+    }
+#else
+    return kernel == AABB_KERNEL_SCALAR;
+#endif
+}
+
+KernelFunction kernelFunction(AabbKernel kernel) {
+    if (!kernelSupported(kernel)) {
+        return intersectScalar;
+    }
+#ifdef AABB_HAVE_X86
+    switch (kernel) {
+    case AABB_KERNEL_AVX:
+        return intersectAvx;
+    case AABB_KERNEL_SSE2:
+        return intersectSse2;
+    default:
+        break;
+    }
+#endif
+    return intersectScalar;
+}
+
+AabbKernel detectBestKernel() {
+    if (kernelSupported(AABB_KERNEL_AVX)) {
+        return AABB_KERNEL_AVX;
+    }
+    if (kernelSupported(AABB_KERNEL_SSE2)) {
+        return AABB_KERNEL_SSE2;
+    }
+    return AABB_KERNEL_SCALAR;
+}
+
+}
+
+bool aabbKernelSupported(AabbKernel kernel) {
+    return kernelSupported(kernel);
+}
+
+AabbKernel bestAabbKernel() {
+    static const AabbKernel best = detectBestKernel();
+    return best;
+}
+
+const char* aabbKernelName(AabbKernel kernel) {
+    switch (kernel) {
+    case AABB_KERNEL_AVX:
+        return "avx";
+    case AABB_KERNEL_SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+std::size_t intersectAabbs(const sf::FloatRect& rect, const AabbArrays& boxes, std::uint32_t* hits) {
+    static const KernelFunction best = kernelFunction(bestAabbKernel());
+
+    // Grid rows hold a handful of tiles. For those the vector setup does not
+    // pay off, and touching AVX for a few boxes now and then costs more in
+    // power-up stalls than the kernel saves.
+    if (boxes.count < SMALL_BATCH) {
+        return intersectScalar(rect.left, rect.top, rect.left + rect.width, rect.top + rect.height, boxes, hits);
+    }
+    return best(rect.left, rect.top, rect.left + rect.width, rect.top + rect.height, boxes, hits);
+}
+
+std::size_t intersectAabbs(AabbKernel kernel, const sf::FloatRect& rect, const AabbArrays& boxes, std::uint32_t* hits) {
+    return kernelFunction(kernel)(rect.left, rect.top, rect.left + rect.width, rect.top + rect.height, boxes, hits);
+}
@@ -0,0 +1,42 @@
+#ifndef AABBBATCH_H
+#define AABBBATCH_H
+
+#include <SFML/Graphics/Rect.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Boxes stored as four parallel arrays of count entries. A box of zero size
+// can share one array for left and right (or top and bottom), which is how
+// point-like data such as ghost positions is tested.
+struct AabbArrays {
+    const float* left;
+    const float* top;
+    const float* right;
+    const float* bottom;
+    std::size_t count;
+};
+
+enum AabbKernel {
+    AABB_KERNEL_SCALAR,
+    AABB_KERNEL_SSE2,
+    AABB_KERNEL_AVX
+};
+
+// Tests rect against every box and writes the indices of the boxes it
+// intersects, in ascending order, to hits (room for boxes.count entries).
+// Returns the number of hits. Matches sf::FloatRect::intersects when rect
+// and boxes have positive size; touching edges do not count as a hit. Uses
+// the widest kernel the CPU supports.
+std::size_t intersectAabbs(const sf::FloatRect& rect, const AabbArrays& boxes, std::uint32_t* hits);
+
+// Same with a specific kernel, for benchmarks. Falls back to scalar if the
+// kernel is not supported on this CPU.
+std::size_t intersectAabbs(AabbKernel kernel, const sf::FloatRect& rect, const AabbArrays& boxes, std::uint32_t* hits);
+
+// Whether this CPU can run kernel; the scalar one always can.
+bool aabbKernelSupported(AabbKernel kernel);
+
+AabbKernel bestAabbKernel();
+const char* aabbKernelName(AabbKernel kernel);
+
+#endif // AABBBATCH_H
@@ -0,0 +1,104 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::size_t> g_allocations(0);
+std::atomic<std::size_t> g_trapped(0);
+
+// Plain data, so they need no initialisation that could itself allocate
+thread_local std::size_t t_allocations = 0;
+thread_local bool t_armed = false;
+thread_local bool t_reported = false;
+
+void count(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    t_allocations++;
+    if (!t_armed) {
+        return;
+    }
+
+    g_trapped.fetch_add(1, std::memory_order_relaxed);
+    if (!t_reported) {
+        t_reported = true;
+        // fprintf does not go through operator new, so this cannot recurse
+        std::fprintf(stderr, "Heap allocation of %zu bytes inside a NoAllocationScope\n", size);
+        assert(!"heap allocation inside a NoAllocationScope");
+    }
+}
+
+void* countedAlloc(std::size_t size) {
+    count(size);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+}
+
+std::size_t allocationCount() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t threadAllocationCount() {
+    return t_allocations;
+}
+
+std::size_t trappedAllocationCount() {
+    return g_trapped.load(std::memory_order_relaxed);
+}
+
+NoAllocationScope::NoAllocationScope(bool armed) : m_wasArmed(t_armed) {
+    if (!armed) {
+        return;
+    }
+    t_armed = true;
+    if (!m_wasArmed) {
+        t_reported = false;
+    }
+}
+
+NoAllocationScope::~NoAllocationScope() {
+    t_armed = m_wasArmed;
+}
+
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    count(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    count(size);
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,37 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <cstddef>
+
+// Counts calls to the global operator new, which AllocationTracker.cpp
+// replaces; linking it in is all it takes. A count costs one relaxed atomic
+// add and one thread-local add.
+
+// Every thread since the program started.
+std::size_t allocationCount();
+
+// The calling thread since it started.
+std::size_t threadAllocationCount();
+
+// Allocations made inside a NoAllocationScope so far, every thread.
+std::size_t trappedAllocationCount();
+
+// Marks code that must not allocate, e.g. a frame of steady-state gameplay.
+// While an armed one is alive on a thread, every allocation the thread
+// makes is counted in trappedAllocationCount() and the first one is
+// reported on stderr with its size. Debug builds (no NDEBUG) also fail an
+// assert there, so a debugger stops on the allocation's call stack. An
+// unarmed scope does nothing, which saves an if around the declaration.
+class NoAllocationScope {
+public:
+    explicit NoAllocationScope(bool armed = true);
+    ~NoAllocationScope();
+
+    NoAllocationScope(const NoAllocationScope&) = delete;
+    NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+
+private:
+    bool m_wasArmed;
+};
+
+#endif // ALLOCATIONTRACKER_H
@@ -0,0 +1,291 @@
+#include "Attacker.h"
+
+#include <algorithm>
+
+#include "AabbBatch.h"
+
+namespace {
+
+const float GHOST_SIZE = 32.0f;
+
+}
+
+Attacker::Attacker(GameEntities& entities, Random& random, Difficulty dif, unsigned int spawnWidth, size_t capacity)
+    : entities(entities), random(random), spawnWidth(spawnWidth), capacity(capacity), ghostCount(0) {
+    captureSpeed = 200.0f; // Speed at which ghost moves towards the player
+    reset(dif);
+}
+
+void Attacker::reset(Difficulty dif) {
+    const ComponentPool<Transform>& transforms = entities.pool<Transform>();
+    for (size_t i = transforms.size(); i-- > 0; ) {
+        if (isGhost(i)) {
+            removeGhost(transforms.entities()[i]);
+        }
+    }
+
+    spawnTimer = 0.0f;
+    if(dif == HARD){
+        spawnInterval = 0.5f;
+    }else {
+        spawnInterval = 1.0f;
+    }
+
+    // Twice the ghosts that are alive at once when none catches the player,
+    // so the pools stop growing early in a round
+    size_t alive = static_cast<size_t>(GAME_HEIGHT / captureSpeed / spawnInterval) + 1;
+    size_t expected = entities.getEntityCount() + std::min(capacity, 2 * alive);
+    entities.reserve(expected);
+    packedX.reserve(expected);
+    packedY.reserve(expected);
+    hits.reserve(expected);
+}
+
+void Attacker::spawn(float deltaTime) {
+    spawnTimer += deltaTime;
+    while (spawnTimer >= spawnInterval) {
+        if (!spawnGhost()) {
+            spawnTimer = 0.0f;
+            break;
+        }
+        spawnTimer -= spawnInterval;
+    }
+}
+
+void Attacker::update(Player& player, JobSystem* jobs) {
+    if (jobs && jobs->getThreadCount() > 1 && entities.pool<Transform>().size() >= PARALLEL_GHOSTS) {
+        updateParallel(player, *jobs);
+        return;
+    }
+
+    resolveCaptures(player);
+    despawnFallen();
+}
+
+// Whether the entity in a Transform slot is a ghost.
+bool Attacker::isGhost(size_t slot) const {
+    const ComponentPool<Collider>& colliders = entities.pool<Collider>();
+    size_t collider = colliders.find(entities.pool<Transform>().entities()[slot], slot);
+    return collider < colliders.size() && colliders.data()[collider].layer == LAYER_GHOST;
+}
+
+// Sizes the packed arrays for count Transform slots. Within the capacity
+// reset() reserved this does not allocate.
+void Attacker::reservePacked(size_t count) {
+    if (packedX.size() < count) {
+        packedX.resize(count);
+        packedY.resize(count);
+        hits.resize(count);
+    }
+}
+
+// Copies the positions of Transform slots [begin, end) into the packed
+// arrays, which must already have room for them.
+void Attacker::packPositions(size_t begin, size_t end) {
+    const Transform* transform = entities.pool<Transform>().data();
+    for (size_t i = begin; i < end; ++i) {
+        packedX[i] = transform[i].position.x;
+        packedY[i] = transform[i].position.y;
+    }
+}
+
+// Transform slot of the first ghost in [begin, end) touching reach, or -1.
+// Reads the packed positions, which must be current for that range. The
+// positions are tested as zero-size boxes in one batch; a hit is rare, so
+// the layer seldom is.
+std::int64_t Attacker::firstTouching(const sf::FloatRect& reach, size_t begin, size_t end) {
+    if (begin == end) {
+        return -1;
+    }
+
+    AabbArrays ghosts = { &packedX[begin], &packedY[begin], &packedX[begin], &packedY[begin], end - begin };
+    std::size_t hitCount = intersectAabbs(reach, ghosts, &hits[begin]);
+    for (std::size_t h = 0; h < hitCount; ++h) {
+        size_t slot = begin + hits[begin + h];
+        if (isGhost(slot)) {
+            return static_cast<std::int64_t>(slot);
+        }
+    }
+    return -1;
+}
+
+void Attacker::resolveCaptures(Player& player) {
+    sf::FloatRect reach = playerReach(player);
+    size_t from = 0;
+    size_t count = entities.pool<Transform>().size();
+    reservePacked(count);
+    packPositions(0, count);
+    for (;;) {
+        std::int64_t hit = firstTouching(reach, from, count);
+        if (hit < 0) {
+            break;
+        }
+        // Catching the player moves it, so test the rest against the new spot.
+        capturePlayer(player);
+        removeGhost(entities.pool<Transform>().entities()[hit]); // Remove ghost upon capturing player
+
+        // Removing swaps the last Transform into the hit slot; that is the
+        // only packed position to refresh. The player's own entry goes stale
+        // but is never taken for a ghost.
+        count = entities.pool<Transform>().size();
+        packPositions(static_cast<size_t>(hit), std::min(static_cast<size_t>(hit) + 1, count));
+
+        // Slots before the hit already missed this reach. A player caught
+        // where it stood (the usual case at the spawn point) only needs the
+        // ghost swapped into the hit slot and the ones after it tested.
+        sf::FloatRect moved = playerReach(player);
+        from = moved == reach ? static_cast<size_t>(hit) : 0;
+        reach = moved;
+    }
+}
+
+void Attacker::despawnFallen() {
+    // Walking backwards keeps swap-and-pop from skipping the moved ghost.
+    const ComponentPool<Transform>& transforms = entities.pool<Transform>();
+    for (size_t i = transforms.size(); i-- > 0; ) {
+        if (transforms.data()[i].position.y >= 1200 && isGhost(i)) {
+            removeGhost(transforms.entities()[i]); // Remove ghost if it reaches the bottom of the screen
+        }
+    }
+}
+
+void Attacker::updateParallel(Player& player, JobSystem& jobs) {
+    const ComponentPool<Transform>& transforms = entities.pool<Transform>();
+    size_t count = transforms.size();
+    size_t pieces = (count + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN;
+    pieceFirstHit.resize(pieces);
+    pieceDespawnCount.resize(pieces);
+    if (despawns.size() < count) {
+        despawns.resize(count);
+    }
+    reservePacked(count);
+
+    // The same player and bottom tests as the serial update, against the
+    // player as it is before any capture.
+    sf::FloatRect reach = playerReach(player);
+    jobs.parallelFor(count, PARALLEL_GRAIN, [&](size_t begin, size_t end, unsigned) {
+        size_t piece = begin / PARALLEL_GRAIN;
+        packPositions(begin, end);
+        pieceFirstHit[piece] = firstTouching(reach, begin, end);
+
+        size_t despawned = 0;
+        for (size_t i = begin; i < end; ++i) {
+            bool fallen = transforms.data()[i].position.y >= 1200 && isGhost(i);
+            despawns[begin + despawned] = static_cast<std::uint32_t>(i);
+            despawned += fallen ? 1 : 0;
+        }
+        pieceDespawnCount[piece] = despawned;
+    });
+
+    // The serial update catches with the lowest touching slot first.
+    std::int64_t firstHit = -1;
+    for (size_t piece = 0; piece < pieces && firstHit < 0; ++piece) {
+        firstHit = pieceFirstHit[piece];
+    }
+
+    if (firstHit >= 0) {
+        // A capture moves the player and reshuffles the pools. That is rare
+        // enough to finish serially, the same way update() does.
+        capturePlayer(player);
+        removeGhost(transforms.entities()[firstHit]);
+        resolveCaptures(player);
+        despawnFallen();
+        return;
+    }
+
+    // Removing the marked ghosts from the highest slot down is what the
+    // serial backwards walk ends up doing.
+    for (size_t piece = pieces; piece-- > 0; ) {
+        size_t begin = piece * PARALLEL_GRAIN;
+        for (size_t j = pieceDespawnCount[piece]; j-- > 0; ) {
+            removeGhost(transforms.entities()[despawns[begin + j]]);
+        }
+    }
+}
+
+// A ghost at (x, y) touches the player when x lies in the open interval
+// (left - GHOST_SIZE, right), same for y, so only its position is tested
+// against the grown player rect.
+sf::FloatRect Attacker::playerReach(const Player& player) const {
+    sf::FloatRect playerBounds = player.getBounds();
+    return sf::FloatRect(playerBounds.left - GHOST_SIZE, playerBounds.top - GHOST_SIZE,
+                         playerBounds.width + GHOST_SIZE, playerBounds.height + GHOST_SIZE);
+}
+
+void Attacker::snapshot(GhostSnapshot& out) const {
+    const ComponentPool<Transform>& transforms = entities.pool<Transform>();
+    out.positionX.clear();
+    out.positionY.clear();
+    out.previousX.clear();
+    out.previousY.clear();
+    for (size_t i = 0, count = transforms.size(); i < count; ++i) {
+        if (!isGhost(i)) {
+            continue;
+        }
+        const Transform& transform = transforms.data()[i];
+        out.positionX.push_back(transform.position.x);
+        out.positionY.push_back(transform.position.y);
+        out.previousX.push_back(transform.previous.x);
+        out.previousY.push_back(transform.previous.y);
+    }
+}
+
+void GhostSnapshot::batch(SpriteBatch& batch, int layer, const TextureRegion& image, float alpha) const {
+    size_t ghostCount = positionX.size();
+    if (ghostCount == 0) {
+        return;
+    }
+
+    // The quad is the image's own size at the ghost's corner, as a sprite
+    // of the ghost texture would be drawn.
+    float width = static_cast<float>(image.rect.width);
+    float height = static_cast<float>(image.rect.height);
+    float u1 = static_cast<float>(image.rect.left);
+    float v1 = static_cast<float>(image.rect.top);
+    float u2 = u1 + width;
+    float v2 = v1 + height;
+
+    sf::Vertex* quad = batch.append(image.texture, layer, ghostCount * 4);
+    for (size_t i = 0; i < ghostCount; ++i, quad += 4) {
+        float x = previousX[i] + (positionX[i] - previousX[i]) * alpha;
+        float y = previousY[i] + (positionY[i] - previousY[i]) * alpha;
+
+        quad[0] = sf::Vertex(sf::Vector2f(x, y), sf::Vector2f(u1, v1));
+        quad[1] = sf::Vertex(sf::Vector2f(x + width, y), sf::Vector2f(u2, v1));
+        quad[2] = sf::Vertex(sf::Vector2f(x + width, y + height), sf::Vector2f(u2, v2));
+        quad[3] = sf::Vertex(sf::Vector2f(x, y + height), sf::Vector2f(u1, v2));
+    }
+}
+
+bool Attacker::spawnGhost() {
+    if (ghostCount == capacity) {
+        return false; // pool is full, skip this spawn
+    }
+
+    Transform transform;
+    transform.position = sf::Vector2f(static_cast<float>(random.nextBelow(spawnWidth)), 0); // Spawn at the top of the window
+    transform.previous = transform.position;
+
+    Velocity velocity;
+    velocity.value = sf::Vector2f(0, captureSpeed);
+
+    Collider collider;
+    collider.size = sf::Vector2f(GHOST_SIZE, GHOST_SIZE);
+    collider.layer = LAYER_GHOST;
+
+    Entity ghost = entities.create();
+    entities.add(ghost, transform);
+    entities.add(ghost, velocity);
+    entities.add(ghost, collider);
+    ghostCount++;
+    return true;
+}
+
+void Attacker::removeGhost(Entity ghost) {
+    entities.destroy(ghost);
+    ghostCount--;
+}
+
+void Attacker::capturePlayer(Player& player) {
+    player.caught();
+}
@@ -0,0 +1,108 @@
+#ifndef ATTACKER_H
+#define ATTACKER_H
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Components.h"
+#include "GameConfig.h"
+#include "JobSystem.h"
+#include "Player.h"
+#include "Random.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+
+// Copy of the live ghosts taken after a tick, so they can be drawn on
+// another thread while the simulation goes on.
+struct GhostSnapshot {
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+
+    // Adds a quad per ghost to batch, showing image. alpha is how far the
+    // frame is between the previous and the current tick.
+    void batch(SpriteBatch& batch, int layer, const TextureRegion& image, float alpha) const;
+};
+
+// Spawns ghosts at the top of the level that fall towards the player. Each
+// ghost is an entity with a Transform, a Velocity and a ghost Collider; the
+// movement system moves them between spawn() and update().
+class Attacker {
+public:
+    static const size_t MAX_GHOSTS = 65536;
+
+    // Ghosts spawn at an x in [0, spawnWidth) drawn from random. entities
+    // and random must outlive the attacker.
+    Attacker(GameEntities& entities, Random& random, Difficulty dif, unsigned int spawnWidth, size_t capacity = MAX_GHOSTS);
+
+    // Removes every ghost and starts spawning afresh for dif.
+    void reset(Difficulty dif);
+
+    // Creates the ghosts due after another deltaTime seconds. Spawns that do
+    // not fit in the pool are dropped, not saved up for later.
+    void spawn(float deltaTime);
+
+    // After movement: catches the player with ghosts touching it and removes
+    // the ones that fell out of the level. With a job system and enough
+    // ghosts the tests are split across threads; the results are merged in
+    // pool order, so captures and despawns come out as in the serial pass.
+    void update(Player& player, JobSystem* jobs = nullptr);
+
+    // Below this many bodies a tick is cheaper than waking the job threads.
+    static const size_t PARALLEL_GHOSTS = 8192;
+    static const size_t PARALLEL_GRAIN = 2048;
+
+    // Copies the live ghosts into out. Its vectors keep their capacity, so
+    // this stops allocating once they have grown to the peak ghost count.
+    void snapshot(GhostSnapshot& out) const;
+
+    size_t getGhostCount() const {
+        return ghostCount;
+    }
+
+    // Shorter intervals (zero, negative, NaN) are taken as this one.
+    static constexpr float MIN_SPAWN_INTERVAL = 1e-6f;
+
+    void setSpawnInterval(float seconds) {
+        spawnInterval = seconds > MIN_SPAWN_INTERVAL ? seconds : MIN_SPAWN_INTERVAL;
+    }
+
+private:
+    GameEntities& entities;
+    Random& random;
+    float spawnTimer; // simulated seconds since the last spawn
+    float spawnInterval;
+    float captureSpeed;
+    unsigned int spawnWidth;
+    size_t capacity;
+    size_t ghostCount;
+
+    // Per piece of a parallel update: the Transform slot of the first ghost
+    // touching the player (or -1) and how many ghosts reached the bottom,
+    // whose slots are kept in despawns from the start of the piece on.
+    std::vector<std::int64_t> pieceFirstHit;
+    std::vector<size_t> pieceDespawnCount;
+    std::vector<std::uint32_t> despawns;
+
+    // Transform positions packed as x and y arrays, by slot, so the player
+    // test is one batch call per range; hits is its output.
+    std::vector<float> packedX;
+    std::vector<float> packedY;
+    std::vector<std::uint32_t> hits;
+
+    bool spawnGhost();
+    void removeGhost(Entity ghost);
+    void capturePlayer(Player& player);
+    sf::FloatRect playerReach(const Player& player) const;
+    bool isGhost(size_t slot) const;
+    void reservePacked(size_t count);
+    void packPositions(size_t begin, size_t end);
+    std::int64_t firstTouching(const sf::FloatRect& reach, size_t begin, size_t end);
+    void resolveCaptures(Player& player);
+    void despawnFallen();
+    void updateParallel(Player& player, JobSystem& jobs);
+};
+
+#endif // ATTACKER_H
@@ -0,0 +1,62 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <SFML/Graphics.hpp>
+
+#include "EntityStore.h"
+
+// Top-left corner of the entity's box, now and at the start of the tick
+// (for interpolated drawing).
+struct Transform {
+    sf::Vector2f position;
+    sf::Vector2f previous;
+    bool facingLeft = false;
+};
+
+// Pixels per second. gravity is added to the vertical speed every second.
+struct Velocity {
+    sf::Vector2f value;
+    float gravity = 0;
+};
+
+enum ColliderLayer {
+    LAYER_PLAYER,
+    LAYER_GHOST
+};
+
+// Axis-aligned box of size at the Transform position. Bodies with
+// sweepTiles are moved by the tile sweep instead of plain movement, and it
+// keeps onGround up to date for them.
+struct Collider {
+    sf::Vector2f size;
+    ColliderLayer layer = LAYER_GHOST;
+    bool sweepTiles = false;
+    bool onGround = false;
+};
+
+// Frame animation on a sheet of frameSize cells: one row while standing on
+// the ground, another in the air. frame is the cell currently shown.
+struct Animation {
+    sf::Vector2i frameSize;
+    int groundRow = 0;
+    int groundFrames = 1;
+    int airRow = 0;
+    int airFrames = 1;
+    float frameTime = 0.1f;
+    float timer = 0; // simulated seconds since the last frame change
+    int frameIndex = 0;
+    sf::IntRect frame;
+};
+
+// Player-style movement: walking speed, jump speed and how many jumps are
+// allowed before landing again. The tile sweep resets jumpCount on landing.
+struct Control {
+    float moveSpeed = 200.0f;
+    float jumpSpeed = 600.0f;
+    int maxJumps = 2;
+    int jumpCount = 0;
+};
+
+typedef EntityStore<Transform, Velocity, Collider, Animation, Control> GameEntities;
+
+#endif // COMPONENTS_H
@@ -0,0 +1,192 @@
+#ifndef ENTITYSTORE_H
+#define ENTITYSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+typedef std::uint32_t Entity;
+
+// One component type as a sparse set: the components themselves sit packed
+// in [0, size()) so systems walk them linearly, and a sparse table maps an
+// entity to its slot. Removing swaps the last component into the hole.
+template <typename T>
+class ComponentPool {
+public:
+    void add(Entity entity, const T& component) {
+        if (entity >= m_sparse.size()) {
+            m_sparse.resize(entity + 1, NONE);
+        }
+        if (m_sparse[entity] != NONE) {
+            m_components[m_sparse[entity]] = component;
+            return;
+        }
+        m_sparse[entity] = static_cast<std::uint32_t>(m_components.size());
+        m_entities.push_back(entity);
+        m_components.push_back(component);
+    }
+
+    void remove(Entity entity) {
+        if (!has(entity)) {
+            return;
+        }
+        std::uint32_t slot = m_sparse[entity];
+        Entity last = m_entities.back();
+        m_components[slot] = m_components.back();
+        m_entities[slot] = last;
+        m_sparse[last] = slot;
+        m_sparse[entity] = NONE;
+        m_components.pop_back();
+        m_entities.pop_back();
+    }
+
+    bool has(Entity entity) const {
+        return entity < m_sparse.size() && m_sparse[entity] != NONE;
+    }
+
+    // The entity must have the component.
+    T& get(Entity entity) {
+        return m_components[m_sparse[entity]];
+    }
+
+    const T& get(Entity entity) const {
+        return m_components[m_sparse[entity]];
+    }
+
+    std::size_t size() const {
+        return m_components.size();
+    }
+
+    // Slot of the entity's component, or size() when it has none. hint is
+    // tried first: pools that gain and lose entities together keep them in
+    // matching slots, so a system walking one pool finds the others'
+    // components at its own index without touching the sparse table.
+    std::size_t find(Entity entity, std::size_t hint) const {
+        if (hint < m_entities.size() && m_entities[hint] == entity) {
+            return hint;
+        }
+        return has(entity) ? m_sparse[entity] : m_entities.size();
+    }
+
+    // Packed components and the entity owning each one, both size() long.
+    T* data() {
+        return m_components.data();
+    }
+
+    const T* data() const {
+        return m_components.data();
+    }
+
+    const Entity* entities() const {
+        return m_entities.data();
+    }
+
+    // Room for components of entities with ids below count.
+    void reserve(std::size_t count) {
+        m_sparse.reserve(count);
+        m_entities.reserve(count);
+        m_components.reserve(count);
+    }
+
+    void clear() {
+        m_sparse.clear();
+        m_entities.clear();
+        m_components.clear();
+    }
+
+private:
+    static constexpr std::uint32_t NONE = 0xffffffffu;
+
+    std::vector<std::uint32_t> m_sparse;
+    std::vector<Entity> m_entities;
+    std::vector<T> m_components;
+};
+
+// Entities and one ComponentPool per listed component type. Ids of
+// destroyed entities are reused, most recently freed first.
+template <typename... Components>
+class EntityStore {
+public:
+    Entity create() {
+        if (!m_free.empty()) {
+            Entity entity = m_free.back();
+            m_free.pop_back();
+            m_alive[entity] = true;
+            return entity;
+        }
+        m_alive.push_back(true);
+        return static_cast<Entity>(m_alive.size() - 1);
+    }
+
+    // Removes the entity from every pool.
+    void destroy(Entity entity) {
+        if (!isAlive(entity)) {
+            return;
+        }
+        removeAll(entity, std::index_sequence_for<Components...>());
+        m_alive[entity] = false;
+        m_free.push_back(entity);
+    }
+
+    bool isAlive(Entity entity) const {
+        return entity < m_alive.size() && m_alive[entity];
+    }
+
+    std::size_t getEntityCount() const {
+        return m_alive.size() - m_free.size();
+    }
+
+    // Room for count entities with every component, so creating them does
+    // not allocate.
+    void reserve(std::size_t count) {
+        m_alive.reserve(count);
+        m_free.reserve(count);
+        reserveAll(count, std::index_sequence_for<Components...>());
+    }
+
+    template <typename T>
+    ComponentPool<T>& pool() {
+        return std::get<ComponentPool<T>>(m_pools);
+    }
+
+    template <typename T>
+    const ComponentPool<T>& pool() const {
+        return std::get<ComponentPool<T>>(m_pools);
+    }
+
+    template <typename T>
+    void add(Entity entity, const T& component) {
+        pool<T>().add(entity, component);
+    }
+
+    template <typename T>
+    T& get(Entity entity) {
+        return pool<T>().get(entity);
+    }
+
+    template <typename T>
+    const T& get(Entity entity) const {
+        return pool<T>().get(entity);
+    }
+
+private:
+    template <std::size_t... I>
+    void removeAll(Entity entity, std::index_sequence<I...>) {
+        int expand[] = { 0, (std::get<I>(m_pools).remove(entity), 0)... };
+        (void)expand;
+    }
+
+    template <std::size_t... I>
+    void reserveAll(std::size_t count, std::index_sequence<I...>) {
+        int expand[] = { 0, (std::get<I>(m_pools).reserve(count), 0)... };
+        (void)expand;
+    }
+
+    std::tuple<ComponentPool<Components>...> m_pools;
+    std::vector<bool> m_alive;
+    std::vector<Entity> m_free;
+};
+
+#endif // ENTITYSTORE_H
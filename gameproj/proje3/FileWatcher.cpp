@@ -0,0 +1,127 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Directory part of path with its trailing separator, empty for none.
+std::string directoryOf(const std::string& path) {
+    std::string::size_type slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+void addOnce(std::vector<std::string>& changed, const std::string& path) {
+    if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+        changed.push_back(path);
+    }
+}
+
+}
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+    m_notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (m_notify != -1) {
+        close(m_notify);
+    }
+#endif
+}
+
+bool FileWatcher::watch(const std::string& path) {
+    m_files[path] = stamp(path);
+
+#ifdef __linux__
+    if (m_notify != -1) {
+        std::string directory = directoryOf(path);
+        for (const auto& watched : m_directories) {
+            if (watched.second == directory) {
+                return true;
+            }
+        }
+
+        int descriptor = inotify_add_watch(m_notify, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (descriptor != -1) {
+            m_directories[descriptor] = directory;
+            return true;
+        }
+        // e.g. out of watches: poll everything instead
+        close(m_notify);
+        m_notify = -1;
+        m_directories.clear();
+    }
+#endif
+    return true;
+}
+
+void FileWatcher::poll(std::vector<std::string>& changed) {
+    if (m_notify != -1) {
+        readEvents(changed);
+    } else if (m_sincePoll.getElapsedTime().asMilliseconds() >= POLL_INTERVAL_MS) {
+        m_sincePoll.restart();
+        pollStamps(changed);
+    }
+}
+
+FileWatcher::Stamp FileWatcher::stamp(const std::string& path) {
+    Stamp result;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+        result.modified = static_cast<long long>(info.st_mtime);
+        result.size = static_cast<long long>(info.st_size);
+    }
+    return result;
+}
+
+void FileWatcher::pollStamps(std::vector<std::string>& changed) {
+    for (auto& file : m_files) {
+        Stamp now = stamp(file.first);
+        if (now.modified != file.second.modified || now.size != file.second.size) {
+            file.second = now;
+            // A deleted file is not a change worth reloading for
+            if (now.size >= 0) {
+                addOnce(changed, file.first);
+            }
+        }
+    }
+}
+
+void FileWatcher::readEvents(std::vector<std::string>& changed) {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(m_notify, buffer, sizeof(buffer));
+        if (length <= 0) {
+            return; // EAGAIN: nothing more queued
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            auto directory = m_directories.find(event->wd);
+            if (directory == m_directories.end() || event->len == 0) {
+                continue;
+            }
+            std::string path = directory->second + event->name;
+            if (m_files.count(path)) {
+                m_files[path] = stamp(path);
+                addOnce(changed, path);
+            }
+        }
+    }
+#else
+    (void)changed;
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <SFML/System/Clock.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+// Reports when watched files are written. On Linux this uses inotify on the
+// files' directories, so saves that replace the file (write to a temporary,
+// then rename) are seen too. Elsewhere, or if inotify is unavailable, the
+// files' modification times and sizes are polled a few times a second.
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // The file does not have to exist yet.
+    bool watch(const std::string& path);
+
+    // Appends each watched path written since the last call, once. Never
+    // blocks.
+    void poll(std::vector<std::string>& changed);
+
+    // How often the fallback looks at the files.
+    static const int POLL_INTERVAL_MS = 250;
+
+private:
+    struct Stamp {
+        long long modified = -1;
+        long long size = -1;
+    };
+
+    static Stamp stamp(const std::string& path);
+    void pollStamps(std::vector<std::string>& changed);
+    void readEvents(std::vector<std::string>& changed);
+
+    std::map<std::string, Stamp> m_files; // watched path -> last seen stamp
+    sf::Clock m_sincePoll;
+
+    // inotify descriptor, or -1 when polling
+    int m_notify = -1;
+    std::map<int, std::string> m_directories; // watch descriptor -> directory as in the watched paths
+};
+
+#endif // FILEWATCHER_H
@@ -0,0 +1,49 @@
+#ifndef FIXEDTIMESTEP_H
+#define FIXEDTIMESTEP_H
+
+#include <algorithm>
+
+// Accumulator for running the simulation at a fixed rate independent of the
+// frame rate. Each frame the real elapsed time is added and the simulation
+// is stepped advance() times by getStep(); what is left over (getAlpha) is
+// used to interpolate rendering between the last two ticks.
+class FixedTimestep {
+public:
+    FixedTimestep(float tickRate, int maxStepsPerFrame)
+        : m_step(1.0f / tickRate), m_maxSteps(maxStepsPerFrame), m_accumulator(0.0f) {}
+
+    // Returns the number of ticks to run for a frame that took frameTime
+    // seconds. After a long hitch at most maxStepsPerFrame ticks are run and
+    // the remaining backlog is dropped, so the game slows down instead of
+    // spiralling into ever longer frames.
+    int advance(float frameTime) {
+        m_accumulator += std::max(0.0f, frameTime);
+        int steps = static_cast<int>(m_accumulator / m_step);
+        if (steps > m_maxSteps) {
+            steps = m_maxSteps;
+            m_accumulator = m_step * steps;
+        }
+        m_accumulator -= m_step * steps;
+        return steps;
+    }
+
+    float getStep() const {
+        return m_step;
+    }
+
+    // How far rendering is between the previous and the current tick, 0-1.
+    float getAlpha() const {
+        return std::min(1.0f, m_accumulator / m_step);
+    }
+
+    void reset() {
+        m_accumulator = 0.0f;
+    }
+
+private:
+    float m_step;
+    int m_maxSteps;
+    float m_accumulator;
+};
+
+#endif // FIXEDTIMESTEP_H
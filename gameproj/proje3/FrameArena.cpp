@@ -0,0 +1,31 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+
+FrameArena::FrameArena(std::size_t capacity)
+    : m_block(new unsigned char[std::max<std::size_t>(capacity, 1)]), m_capacity(std::max<std::size_t>(capacity, 1)) {
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t alignment) {
+    std::size_t start = (m_used + alignment - 1) & ~(alignment - 1);
+    if (start + size <= m_capacity) {
+        m_used = start + size;
+        return m_block.get() + start;
+    }
+
+    // new[] aligns for any fundamental type
+    m_overflow.emplace_back(new unsigned char[std::max<std::size_t>(size, 1)]);
+    m_overflowBytes += size;
+    return m_overflow.back().get();
+}
+
+void FrameArena::reset() {
+    if (m_overflowBytes > 0) {
+        // Room for everything this frame needed, with headroom for the next
+        m_capacity = std::max(m_capacity * 2, (m_used + m_overflowBytes) * 3 / 2);
+        m_block.reset(new unsigned char[m_capacity]);
+        m_overflow.clear();
+        m_overflowBytes = 0;
+    }
+    m_used = 0;
+}
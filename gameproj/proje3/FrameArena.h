@@ -0,0 +1,79 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that only lives for one frame or tick:
+// allocate() hands out the next bytes of one block and reset() takes them
+// all back at once. A frame that needs more than the block holds gets the
+// rest from the heap, and the next reset() grows the block to cover it, so
+// after the first few frames nothing reaches operator new. Not thread-safe.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t capacity = 16 * 1024);
+
+    // alignment must be a power of two no larger than alignof(std::max_align_t).
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    // Frees everything allocated since the last reset.
+    void reset();
+
+    std::size_t getCapacity() const {
+        return m_capacity;
+    }
+
+    // Bytes handed out since the last reset, heap overflow included.
+    std::size_t getUsed() const {
+        return m_used + m_overflowBytes;
+    }
+
+private:
+    std::unique_ptr<unsigned char[]> m_block;
+    std::size_t m_capacity;
+    std::size_t m_used = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> m_overflow;
+    std::size_t m_overflowBytes = 0;
+};
+
+// Standard allocator over a FrameArena, for containers whose contents are
+// gone by the arena's next reset(). Deallocating does nothing.
+template <typename T>
+class FrameAllocator {
+public:
+    typedef T value_type;
+
+    explicit FrameAllocator(FrameArena& arena) : m_arena(&arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : m_arena(other.getArena()) {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) {}
+
+    FrameArena* getArena() const {
+        return m_arena;
+    }
+
+private:
+    FrameArena* m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.getArena() == b.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) {
+    return a.getArena() != b.getArena();
+}
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif // FRAMEARENA_H
@@ -0,0 +1,179 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "AllocationTracker.h"
+
+const char* profilePhaseName(ProfilePhase phase) {
+    switch (phase) {
+    case PHASE_EVENTS: return "events";
+    case PHASE_PLAYER: return "player";
+    case PHASE_COLLISION: return "collision";
+    case PHASE_ATTACKER: return "attacker";
+    case PHASE_VIEW: return "view";
+    case PHASE_DRAW: return "draw";
+    case PHASE_PRESENT: return "present";
+    default: return "?";
+    }
+}
+
+FrameProfiler::FrameProfiler(std::size_t frameCount) : m_frames(std::max<std::size_t>(frameCount, 1)), m_epoch(Clock::now()) {
+}
+
+double FrameProfiler::now() const {
+    return std::chrono::duration<double, std::micro>(Clock::now() - m_epoch).count();
+}
+
+void FrameProfiler::beginFrame() {
+    m_current = FrameSample();
+    m_current.start = now();
+    m_allocationsBegin = threadAllocationCount();
+    std::fill(m_current.phaseStart, m_current.phaseStart + PHASE_COUNT, -1.0);
+}
+
+void FrameProfiler::endFrame() {
+    m_current.duration = static_cast<float>(now() - m_current.start);
+    m_current.allocations = static_cast<unsigned>(threadAllocationCount() - m_allocationsBegin);
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        if (m_current.phaseStart[phase] < 0) {
+            m_current.phaseStart[phase] = m_current.start; // never ran
+        }
+    }
+
+    m_frames[m_next] = m_current;
+    m_next = (m_next + 1) % m_frames.size();
+    m_count = std::min(m_count + 1, m_frames.size());
+}
+
+void FrameProfiler::begin(ProfilePhase phase) {
+    m_phaseBegin[phase] = now();
+    if (m_current.phaseStart[phase] < 0) {
+        m_current.phaseStart[phase] = m_phaseBegin[phase];
+    }
+}
+
+void FrameProfiler::end(ProfilePhase phase) {
+    m_current.phaseTime[phase] += static_cast<float>(now() - m_phaseBegin[phase]);
+}
+
+const FrameSample& FrameProfiler::getFrame(std::size_t index) const {
+    std::size_t oldest = m_count < m_frames.size() ? 0 : m_next;
+    return m_frames[(oldest + index) % m_frames.size()];
+}
+
+float FrameProfiler::getAveragePhaseTime(ProfilePhase phase) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (std::size_t i = 0; i < m_count; ++i) {
+        sum += m_frames[i].phaseTime[phase];
+    }
+    return static_cast<float>(sum / m_count / 1000.0);
+}
+
+float FrameProfiler::getAverageFrameTime() const {
+    if (m_count == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (std::size_t i = 0; i < m_count; ++i) {
+        sum += m_frames[i].duration;
+    }
+    return static_cast<float>(sum / m_count / 1000.0);
+}
+
+float FrameProfiler::getAverageDrawCalls() const {
+    if (m_count == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (std::size_t i = 0; i < m_count; ++i) {
+        sum += m_frames[i].drawCalls;
+    }
+    return static_cast<float>(sum / m_count);
+}
+
+float FrameProfiler::getAverageVertices() const {
+    if (m_count == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (std::size_t i = 0; i < m_count; ++i) {
+        sum += m_frames[i].vertices;
+    }
+    return static_cast<float>(sum / m_count);
+}
+
+float FrameProfiler::getAverageAllocations() const {
+    if (m_count == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (std::size_t i = 0; i < m_count; ++i) {
+        sum += m_frames[i].allocations;
+    }
+    return static_cast<float>(sum / m_count);
+}
+
+bool FrameProfiler::writeCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(3);
+    file << "frame,start_us,frame_ms";
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        file << ',' << profilePhaseName(static_cast<ProfilePhase>(phase)) << "_ms";
+    }
+    file << ",draw_calls,vertices,allocations\n";
+
+    for (std::size_t i = 0; i < m_count; ++i) {
+        const FrameSample& frame = getFrame(i);
+        file << i << ',' << static_cast<long long>(frame.start) << ',' << frame.duration / 1000.0f;
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            file << ',' << frame.phaseTime[phase] / 1000.0f;
+        }
+        file << ',' << frame.drawCalls << ',' << frame.vertices << ',' << frame.allocations << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Could not write " << path << std::endl;
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(1);
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (std::size_t i = 0; i < m_count; ++i) {
+        const FrameSample& frame = getFrame(i);
+
+        file << (first ? "" : ",\n")
+             << "{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << frame.start
+             << ",\"dur\":" << frame.duration << ",\"args\":{\"drawCalls\":" << frame.drawCalls
+             << ",\"vertices\":" << frame.vertices << ",\"allocations\":" << frame.allocations << "}}";
+        first = false;
+
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            if (frame.phaseTime[phase] <= 0) {
+                continue;
+            }
+            file << ",\n{\"name\":\"" << profilePhaseName(static_cast<ProfilePhase>(phase))
+                 << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << phase + 2 << ",\"ts\":" << frame.phaseStart[phase]
+                 << ",\"dur\":" << frame.phaseTime[phase] << "}";
+        }
+    }
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,116 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Parts of a frame that get their own timer.
+enum ProfilePhase {
+    PHASE_EVENTS,    // window events and asset uploads
+    PHASE_PLAYER,    // input, gravity and animation
+    PHASE_COLLISION, // crown check, tile query and sweep
+    PHASE_ATTACKER,  // ghost spawning, body movement, captures
+    PHASE_VIEW,      // camera, parallax and HUD text
+    PHASE_DRAW,      // clear and draw calls
+    PHASE_PRESENT,   // display, including the wait for vsync
+    PHASE_COUNT
+};
+
+const char* profilePhaseName(ProfilePhase phase);
+
+// One recorded frame. A phase that ran several times in the frame (one
+// simulation tick each) has its time summed and starts where it first ran.
+// Times are in microseconds, starts relative to when profiling began.
+struct FrameSample {
+    double start = 0;
+    float duration = 0;
+    double phaseStart[PHASE_COUNT] = {};
+    float phaseTime[PHASE_COUNT] = {};
+    unsigned drawCalls = 0;
+    unsigned vertices = 0; // submitted by those draw calls
+    unsigned allocations = 0; // operator new calls on the profiled thread
+};
+
+// Keeps the last frames in a ring buffer. A timer costs two steady_clock
+// reads; nothing allocates after construction. Frames are counted on the
+// thread calling beginFrame() and endFrame(), and so are their allocations.
+class FrameProfiler {
+public:
+    explicit FrameProfiler(std::size_t frameCount = 240);
+
+    void beginFrame();
+    void endFrame();
+
+    void begin(ProfilePhase phase);
+    void end(ProfilePhase phase);
+
+    void addDrawCalls(unsigned count) {
+        m_current.drawCalls += count;
+    }
+
+    void addVertices(unsigned count) {
+        m_current.vertices += count;
+    }
+
+    // Recorded frames, 0 being the oldest one still kept.
+    std::size_t getFrameCount() const {
+        return m_count;
+    }
+    const FrameSample& getFrame(std::size_t index) const;
+
+    // Averages over every frame kept, in milliseconds.
+    float getAveragePhaseTime(ProfilePhase phase) const;
+    float getAverageFrameTime() const;
+    float getAverageDrawCalls() const;
+    float getAverageVertices() const;
+    float getAverageAllocations() const;
+
+    // One row per frame: frame, start_us, frame_ms, one column per phase in
+    // ms, draw_calls, vertices, allocations.
+    bool writeCsv(const std::string& path) const;
+
+    // Chrome trace event JSON (chrome://tracing, Perfetto). Frames are one
+    // track and each phase gets a track of its own below it.
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    double now() const;
+
+    std::vector<FrameSample> m_frames;
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    FrameSample m_current;
+    double m_phaseBegin[PHASE_COUNT] = {};
+    std::size_t m_allocationsBegin = 0;
+    Clock::time_point m_epoch;
+};
+
+// Times the enclosing scope as phase. A null profiler turns it into a
+// no-op, so code shared with headless runs can always have the scope.
+class ProfileScope {
+public:
+    ProfileScope(FrameProfiler* profiler, ProfilePhase phase) : m_profiler(profiler), m_phase(phase) {
+        if (m_profiler) {
+            m_profiler->begin(m_phase);
+        }
+    }
+
+    ~ProfileScope() {
+        if (m_profiler) {
+            m_profiler->end(m_phase);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    FrameProfiler* m_profiler;
+    ProfilePhase m_phase;
+};
+
+#endif // FRAMEPROFILER_H
@@ -0,0 +1,31 @@
+#ifndef GAMECONFIG_H
+#define GAMECONFIG_H
+
+const int WINDOW_WIDTH = 800;
+const int WINDOW_HEIGHT = 600;
+const int GAME_WIDTH = 1600;
+const int GAME_HEIGHT = 1200;
+
+// Where the player starts a round and goes back to when caught
+const float PLAYER_SPAWN_X = 1.0f;
+const float PLAYER_SPAWN_Y = 1100.0f;
+
+// The simulation runs at a fixed rate regardless of how fast frames are drawn.
+// Player movement is swept against the tiles, so large steps cannot tunnel
+// through platforms and the rate only needs to be high enough for feel.
+const float SIM_TICK_RATE = 60.0f;
+const int SIM_MAX_STEPS_PER_FRAME = 8;
+
+enum GameState {
+    MENU,
+    GAME,
+    WIN,
+    EXIT
+};
+
+enum Difficulty {
+    NORMAL,
+    HARD
+};
+
+#endif // GAMECONFIG_H
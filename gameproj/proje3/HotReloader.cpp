@@ -0,0 +1,105 @@
+#include "HotReloader.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "Level.h"
+
+namespace {
+
+bool isBinaryLevel(const std::string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".lvl") == 0;
+}
+
+}
+
+HotReloader::HotReloader(ResourceManager& resources)
+    : m_resources(resources), m_loader(&HotReloader::loaderLoop, this) {
+}
+
+HotReloader::~HotReloader() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_loader.join();
+}
+
+void HotReloader::watchTexture(const std::string& path) {
+    m_watcher.watch(path);
+}
+
+void HotReloader::watchLevel(const std::string& path) {
+    m_watcher.watch(path);
+    m_levels.push_back(path);
+}
+
+void HotReloader::setTileset(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const sf::IntRect& region) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tileset = tileset;
+    m_tileSize = tileSize;
+    m_tilesetRegion = region;
+}
+
+void HotReloader::reloadLevel(const std::string& path) {
+    std::unique_ptr<LevelReload> reload(new LevelReload());
+    reload->path = path;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = std::move(reload);
+    }
+    m_wake.notify_one();
+}
+
+std::unique_ptr<LevelReload> HotReloader::update() {
+    m_changed.clear();
+    m_watcher.poll(m_changed);
+    for (const std::string& path : m_changed) {
+        if (std::find(m_levels.begin(), m_levels.end(), path) != m_levels.end()) {
+            reloadLevel(path);
+        } else {
+            m_resources.reload(path);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_finished);
+}
+
+void HotReloader::loaderLoop() {
+    while (true) {
+        std::unique_ptr<LevelReload> reload;
+        std::shared_ptr<const sf::Texture> tileset;
+        sf::Vector2u tileSize;
+        sf::IntRect region;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || (m_pending && m_tileset); });
+            if (m_stopping) {
+                return;
+            }
+            reload = std::move(m_pending);
+            tileset = m_tileset;
+            tileSize = m_tileSize;
+            region = m_tilesetRegion;
+        }
+
+        // Only the map is kept; it copies everything it needs out of the level.
+        sf::Clock clock;
+        Level level;
+        bool loaded = isBinaryLevel(reload->path) ? level.loadBinary(reload->path) : level.loadText(reload->path);
+        if (loaded) {
+            reload->tileMap.reset(new TileMap());
+            loaded = reload->tileMap->prepare(tileset, tileSize, level.view(), region);
+        }
+        if (!loaded) {
+            std::cerr << "Could not reload level " << reload->path << ", keeping the old one" << std::endl;
+            continue;
+        }
+        reload->buildTime = clock.getElapsedTime().asSeconds() * 1000.0f;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished = std::move(reload);
+    }
+}
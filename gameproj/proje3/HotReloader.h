@@ -0,0 +1,77 @@
+#ifndef HOTRELOADER_H
+#define HOTRELOADER_H
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FileWatcher.h"
+#include "ResourceManager.h"
+#include "TileMap.h"
+
+// A level rebuilt after its file changed, ready to be swapped in.
+struct LevelReload {
+    std::string path;
+    std::unique_ptr<TileMap> tileMap; // prepared, not uploaded yet
+    float buildTime = 0;  // ms the loader thread spent reading the file and building the map
+    sf::Clock sinceChange; // running since the change was seen
+};
+
+// Reloads level files and textures while the game runs. A changed texture
+// goes back through the ResourceManager, which puts the new pixels into the
+// handle everyone already holds. A changed level is parsed and turned into
+// a TileMap on the reloader's own thread; update() hands it to the frame
+// loop, which only has to upload it and swap it in between two frames.
+class HotReloader {
+public:
+    // resources must outlive the reloader.
+    explicit HotReloader(ResourceManager& resources);
+    ~HotReloader();
+
+    HotReloader(const HotReloader&) = delete;
+    HotReloader& operator=(const HotReloader&) = delete;
+
+    void watchTexture(const std::string& path);
+
+    // Files ending in ".lvl" are loaded as binary levels, others as text.
+    void watchLevel(const std::string& path);
+
+    // What levels are built with from now on; nothing is rebuilt before
+    // this has been called once.
+    void setTileset(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const sf::IntRect& region);
+
+    // Rebuilds path as if it had changed, e.g. after the tileset moved.
+    void reloadLevel(const std::string& path);
+
+    // Call once a frame on the thread that owns the window. Starts reloads
+    // for files written since the last call and returns the newest level
+    // that finished building since then, or null.
+    std::unique_ptr<LevelReload> update();
+
+private:
+    void loaderLoop();
+
+    ResourceManager& m_resources;
+    FileWatcher m_watcher;
+    std::vector<std::string> m_levels;
+    std::vector<std::string> m_changed; // reused by update()
+
+    // Shared with the loader thread. A change seen while a level is still
+    // building replaces the pending one, so only the newest is built.
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::shared_ptr<const sf::Texture> m_tileset;
+    sf::Vector2u m_tileSize;
+    sf::IntRect m_tilesetRegion;
+    std::unique_ptr<LevelReload> m_pending;
+    std::unique_ptr<LevelReload> m_finished;
+
+    std::thread m_loader;
+};
+
+#endif // HOTRELOADER_H
@@ -0,0 +1,171 @@
+#include "HudText.h"
+
+#include <algorithm>
+
+namespace {
+
+// Longest int: a sign and ten digits
+const std::size_t MAX_NUMBER_LENGTH = 11;
+
+// Writes value in decimal to out, which has room for MAX_NUMBER_LENGTH
+// characters. Returns how many were written.
+std::size_t formatInt(int value, char* out) {
+    char reversed[MAX_NUMBER_LENGTH];
+    std::size_t length = 0;
+    // Through unsigned so that INT_MIN negates too
+    unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+    do {
+        reversed[length++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    std::size_t written = 0;
+    if (value < 0) {
+        out[written++] = '-';
+    }
+    while (length > 0) {
+        out[written++] = reversed[--length];
+    }
+    return written;
+}
+
+}
+
+HudText::HudText(const sf::Font& font, unsigned int characterSize, const sf::Vector2f& position, sf::Color color)
+    : m_position(position), m_color(color) {
+    setFont(font, characterSize);
+}
+
+void HudText::setFont(const sf::Font& font, unsigned int characterSize) {
+    m_font = &font;
+    m_characterSize = characterSize;
+
+    // Same padding as layoutText()
+    const float padding = 1.0f;
+    const char digits[] = "0123456789-";
+    for (std::size_t i = 0; i < sizeof(m_digits) / sizeof(m_digits[0]); ++i) {
+        const sf::Glyph& glyph = font.getGlyph(static_cast<sf::Uint32>(digits[i]), characterSize, false);
+        DigitGlyph& digit = m_digits[i];
+        digit.rect = sf::FloatRect(glyph.bounds.left - padding, glyph.bounds.top - padding,
+                                   glyph.bounds.width + 2 * padding, glyph.bounds.height + 2 * padding);
+        digit.texCoords = sf::FloatRect(glyph.textureRect.left - padding, glyph.textureRect.top - padding,
+                                        glyph.textureRect.width + 2 * padding, glyph.textureRect.height + 2 * padding);
+        digit.advance = glyph.advance;
+    }
+    layout();
+}
+
+void HudText::setPosition(const sf::Vector2f& position) {
+    sf::Vector2f offset = position - m_position;
+    if (offset == sf::Vector2f()) {
+        return;
+    }
+    m_position = position;
+    for (sf::Vertex& vertex : m_vertices) {
+        vertex.position += offset;
+    }
+}
+
+void HudText::setColor(sf::Color color) {
+    m_color = color;
+    for (sf::Vertex& vertex : m_vertices) {
+        vertex.color = color;
+    }
+}
+
+void HudText::setString(const std::string& string) {
+    if (string == m_string) {
+        return;
+    }
+    m_string = string;
+    layout();
+}
+
+void HudText::setString(const char* string) {
+    if (m_string == string) {
+        return;
+    }
+    m_string = string;
+    layout();
+}
+
+void HudText::setNumber(int value) {
+    if (m_showNumber && value == m_number) {
+        return;
+    }
+    m_showNumber = true;
+    m_number = value;
+    layoutNumber();
+}
+
+sf::FloatRect HudText::getLocalBounds() const {
+    if (m_vertices.empty()) {
+        return sf::FloatRect();
+    }
+    float left = m_vertices[0].position.x;
+    float top = m_vertices[0].position.y;
+    float right = left;
+    float bottom = top;
+    for (const sf::Vertex& vertex : m_vertices) {
+        left = std::min(left, vertex.position.x);
+        top = std::min(top, vertex.position.y);
+        right = std::max(right, vertex.position.x);
+        bottom = std::max(bottom, vertex.position.y);
+    }
+    return sf::FloatRect(left - m_position.x, top - m_position.y, right - left, bottom - top);
+}
+
+void HudText::batch(SpriteBatch& batch, int layer) const {
+    if (m_font && !m_vertices.empty()) {
+        batch.addQuads(&m_font->getTexture(m_characterSize), layer, m_vertices.data(), m_vertices.size());
+    }
+}
+
+void HudText::layout() {
+    m_vertices.clear();
+    m_numberStart = 0;
+    m_pen = sf::Vector2f();
+    if (!m_font) {
+        return;
+    }
+
+    m_pen = layoutText(*m_font, m_string, m_characterSize, m_position, m_color, m_vertices);
+    m_numberStart = m_vertices.size();
+    m_vertices.reserve(m_numberStart + 4 * MAX_NUMBER_LENGTH);
+    if (m_showNumber) {
+        layoutNumber();
+    }
+}
+
+void HudText::layoutNumber() {
+    if (!m_font) {
+        return;
+    }
+
+    // Digits are not kerned against each other, which matches the fonts'
+    // tabular figures.
+    char text[MAX_NUMBER_LENGTH];
+    std::size_t length = formatInt(m_number, text);
+    m_vertices.resize(m_numberStart + 4 * length);
+
+    float x = m_position.x + m_pen.x;
+    float y = m_position.y + m_pen.y;
+    sf::Vertex* quad = &m_vertices[m_numberStart];
+    for (std::size_t i = 0; i < length; ++i, quad += 4) {
+        const DigitGlyph& digit = m_digits[text[i] == '-' ? 10 : text[i] - '0'];
+        float left = x + digit.rect.left;
+        float top = y + digit.rect.top;
+        float right = left + digit.rect.width;
+        float bottom = top + digit.rect.height;
+        float u1 = digit.texCoords.left;
+        float v1 = digit.texCoords.top;
+        float u2 = u1 + digit.texCoords.width;
+        float v2 = v1 + digit.texCoords.height;
+
+        quad[0] = sf::Vertex(sf::Vector2f(left, top), m_color, sf::Vector2f(u1, v1));
+        quad[1] = sf::Vertex(sf::Vector2f(right, top), m_color, sf::Vector2f(u2, v1));
+        quad[2] = sf::Vertex(sf::Vector2f(right, bottom), m_color, sf::Vector2f(u2, v2));
+        quad[3] = sf::Vertex(sf::Vector2f(left, bottom), m_color, sf::Vector2f(u1, v2));
+        x += digit.advance;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef HUDTEXT_H
+#define HUDTEXT_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+#include "SpriteBatch.h"
+
+// Text drawn every frame whose glyph quads are laid out once and kept:
+// setString() lays them out again only when the string differs. A number
+// shown after the string (setNumber()) is put together from digit quads
+// baked when the font is set, so a changing value never touches the font
+// or formats through iostreams, and nothing allocates once the longest
+// value has been shown.
+class HudText {
+public:
+    HudText() = default;
+    HudText(const sf::Font& font, unsigned int characterSize, const sf::Vector2f& position,
+            sf::Color color = sf::Color::White);
+
+    void setFont(const sf::Font& font, unsigned int characterSize);
+    void setPosition(const sf::Vector2f& position);
+    void setColor(sf::Color color);
+
+    // Both keep the string's capacity, so a string no longer than one
+    // shown before does not allocate.
+    void setString(const std::string& string);
+    void setString(const char* string);
+
+    const std::string& getString() const {
+        return m_string;
+    }
+
+    // Shows value right after the string, e.g. "Y: " then 12.
+    void setNumber(int value);
+
+    // Size of the laid out text, for centring it.
+    sf::FloatRect getLocalBounds() const;
+
+    // Adds the cached quads to batch.
+    void batch(SpriteBatch& batch, int layer) const;
+
+private:
+    // A digit's quad relative to the pen, and how far it moves the pen.
+    struct DigitGlyph {
+        sf::FloatRect rect;
+        sf::FloatRect texCoords;
+        float advance = 0;
+    };
+
+    void layout();
+    void layoutNumber();
+
+    const sf::Font* m_font = nullptr;
+    unsigned int m_characterSize = 30;
+    sf::Vector2f m_position;
+    sf::Color m_color = sf::Color::White;
+    std::string m_string;
+
+    bool m_showNumber = false;
+    int m_number = 0;
+    DigitGlyph m_digits[11]; // '0' to '9', then '-'
+
+    // The string's quads, then the number's from m_numberStart on
+    std::vector<sf::Vertex> m_vertices;
+    std::size_t m_numberStart = 0;
+    sf::Vector2f m_pen; // where the number starts, relative to m_position
+};
+
+#endif // HUDTEXT_H
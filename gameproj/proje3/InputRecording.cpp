@@ -0,0 +1,136 @@
+#include "InputRecording.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+void InputRecording::begin(Difficulty difficulty, std::uint64_t seed, float step) {
+    m_difficulty = difficulty;
+    m_seed = seed;
+    m_step = step;
+    m_ticks.clear();
+    m_ticks.reserve(RECORDING_CHUNK_TICKS);
+}
+
+void InputRecording::reserveAhead(std::size_t ticks) {
+    if (m_ticks.size() + ticks > m_ticks.capacity()) {
+        m_ticks.reserve(m_ticks.capacity() + std::max(ticks, RECORDING_CHUNK_TICKS));
+    }
+}
+
+void InputRecording::record(const WorldInput& input) {
+    std::uint8_t bits = 0;
+    bits |= input.left ? INPUT_LEFT : 0;
+    bits |= input.right ? INPUT_RIGHT : 0;
+    bits |= input.jump ? INPUT_JUMP : 0;
+    bits |= input.stop ? INPUT_STOP : 0;
+    m_ticks.push_back(bits);
+}
+
+WorldInput InputRecording::getInput(std::size_t tick) const {
+    std::uint8_t bits = m_ticks[tick];
+    WorldInput input;
+    input.left = (bits & INPUT_LEFT) != 0;
+    input.right = (bits & INPUT_RIGHT) != 0;
+    input.jump = (bits & INPUT_JUMP) != 0;
+    input.stop = (bits & INPUT_STOP) != 0;
+    return input;
+}
+
+bool InputRecording::save(const std::string& filePath) const {
+    std::vector<std::uint8_t> runs;
+    std::uint32_t runCount = 0;
+    for (std::size_t i = 0; i < m_ticks.size();) {
+        std::size_t end = i + 1;
+        while (end < m_ticks.size() && m_ticks[end] == m_ticks[i]) {
+            end++;
+        }
+
+        runs.push_back(m_ticks[i]);
+        std::size_t length = end - i;
+        do {
+            std::uint8_t byte = length & 0x7f;
+            length >>= 7;
+            runs.push_back(length != 0 ? (byte | 0x80) : byte);
+        } while (length != 0);
+        runCount++;
+        i = end;
+    }
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    InputFileHeader header;
+    std::memcpy(header.magic, INPUT_FILE_MAGIC, sizeof(header.magic));
+    header.version = INPUT_FILE_VERSION;
+    header.difficulty = static_cast<std::uint32_t>(m_difficulty);
+    header.tickCount = static_cast<std::uint32_t>(m_ticks.size());
+    header.seed = m_seed;
+    header.step = m_step;
+    header.runCount = runCount;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(runs.data()), runs.size());
+    return static_cast<bool>(file);
+}
+
+bool InputRecording::load(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    InputFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, INPUT_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != INPUT_FILE_VERSION) {
+        return false;
+    }
+    std::vector<std::uint8_t> runs((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    std::vector<std::uint8_t> ticks;
+    ticks.reserve(header.tickCount);
+    std::size_t at = 0;
+    for (std::uint32_t run = 0; run < header.runCount; ++run) {
+        if (at >= runs.size()) {
+            return false;
+        }
+        std::uint8_t bits = runs[at++];
+
+        std::size_t length = 0;
+        unsigned shift = 0;
+        while (true) {
+            if (at >= runs.size() || shift > 28) {
+                return false;
+            }
+            std::uint8_t byte = runs[at++];
+            length |= static_cast<std::size_t>(byte & 0x7f) << shift;
+            shift += 7;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        if (length > header.tickCount - ticks.size()) {
+            return false;
+        }
+        ticks.insert(ticks.end(), length, bits);
+    }
+    if (ticks.size() != header.tickCount) {
+        return false;
+    }
+
+    m_difficulty = header.difficulty == HARD ? HARD : NORMAL;
+    m_seed = header.seed;
+    m_step = header.step;
+    m_ticks.swap(ticks);
+    return true;
+}
+
+std::size_t replay(World& world, const InputRecording& recording) {
+    world.start(recording.getDifficulty(), recording.getSeed());
+    for (std::size_t tick = 0; tick < recording.getTickCount(); ++tick) {
+        if (world.tick(recording.getStep(), recording.getInput(tick))) {
+            return tick + 1;
+        }
+    }
+    return recording.getTickCount();
+}
@@ -0,0 +1,88 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GameConfig.h"
+#include "World.h"
+
+// Input file: this header followed by runCount runs of identical ticks,
+// each the tick's input flags (one byte, INPUT_* bits) and the run length
+// as an unsigned LEB128 varint. A held key costs a few bytes however long
+// it is held. Little endian.
+struct InputFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t difficulty;
+    std::uint32_t tickCount;
+    std::uint64_t seed;
+    float step;
+    std::uint32_t runCount;
+};
+
+const char INPUT_FILE_MAGIC[4] = { 'I', 'N', 'P', 'T' };
+const std::uint32_t INPUT_FILE_VERSION = 1;
+
+// Ticks of input storage added at a time: ten minutes.
+const std::size_t RECORDING_CHUNK_TICKS = static_cast<std::size_t>(10 * 60 * SIM_TICK_RATE);
+
+enum InputBits {
+    INPUT_LEFT = 1,
+    INPUT_RIGHT = 2,
+    INPUT_JUMP = 4,
+    INPUT_STOP = 8
+};
+
+// What a round was started with and the input of each of its ticks: all
+// World needs to play the round again exactly.
+class InputRecording {
+public:
+    // Drops what was recorded and starts over for a new round.
+    void begin(Difficulty difficulty, std::uint64_t seed, float step);
+
+    // Appends the input of the next tick. Does not allocate while there is
+    // room left from begin() or reserveAhead().
+    void record(const WorldInput& input);
+
+    // Makes sure the next ticks record() calls do not allocate, growing the
+    // storage RECORDING_CHUNK_TICKS at a time.
+    void reserveAhead(std::size_t ticks);
+
+    bool save(const std::string& filePath) const;
+    bool load(const std::string& filePath);
+
+    Difficulty getDifficulty() const {
+        return m_difficulty;
+    }
+
+    std::uint64_t getSeed() const {
+        return m_seed;
+    }
+
+    float getStep() const {
+        return m_step;
+    }
+
+    std::size_t getTickCount() const {
+        return m_ticks.size();
+    }
+
+    WorldInput getInput(std::size_t tick) const;
+
+private:
+    Difficulty m_difficulty = NORMAL;
+    std::uint64_t m_seed = 0;
+    float m_step = 1.0f / SIM_TICK_RATE;
+    std::vector<std::uint8_t> m_ticks; // INPUT_* bits per tick
+};
+
+// Starts a round on world from recording and runs its ticks as fast as they
+// go. world must collide with the level the recording was made on. Returns
+// the number of ticks run, which is fewer than recorded only if the player
+// reached a crown before the end.
+std::size_t replay(World& world, const InputRecording& recording);
+
+#endif // INPUTRECORDING_H
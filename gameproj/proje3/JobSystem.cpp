@@ -0,0 +1,119 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned threadCount) : m_remaining(0) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 1; i < threadCount; ++i) {
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::run(std::size_t count, std::size_t grain, Invoke invoke, const void* job) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    std::size_t pieceCount = (count + grain - 1) / grain;
+
+    if (m_workers.empty() || pieceCount == 1) {
+        for (std::size_t begin = 0; begin < count; begin += grain) {
+            invoke(job, begin, std::min(begin + grain, count), 0);
+        }
+        return;
+    }
+
+    // Every thread starts with a contiguous run of pieces so neighbouring
+    // data stays on one core unless someone has to steal it.
+    m_invoke = invoke;
+    m_job = job;
+    m_count = count;
+    m_grain = grain;
+    m_remaining = pieceCount;
+    unsigned threads = getThreadCount();
+    for (unsigned t = 0; t < threads; ++t) {
+        std::lock_guard<std::mutex> lock(m_queues[t]->mutex);
+        m_queues[t]->next = pieceCount * t / threads;
+        m_queues[t]->end = pieceCount * (t + 1) / threads;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runPieces(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_remaining == 0; });
+    m_job = nullptr;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    unsigned seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+            if (m_stopping) {
+                return;
+            }
+            seen = m_generation;
+        }
+        runPieces(index);
+    }
+}
+
+void JobSystem::runPieces(unsigned index) {
+    std::size_t piece;
+    while (popPiece(index, piece) || stealPiece(index, piece)) {
+        std::size_t begin = piece * m_grain;
+        m_invoke(m_job, begin, std::min(begin + m_grain, m_count), index);
+
+        if (--m_remaining == 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+    }
+}
+
+bool JobSystem::popPiece(unsigned index, std::size_t& piece) {
+    Queue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.next == queue.end) {
+        return false;
+    }
+    piece = queue.next++;
+    return true;
+}
+
+bool JobSystem::stealPiece(unsigned index, std::size_t& piece) {
+    unsigned threads = getThreadCount();
+    for (unsigned offset = 1; offset < threads; ++offset) {
+        Queue& queue = *m_queues[(index + offset) % threads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.next != queue.end) {
+            piece = --queue.end;
+            return true;
+        }
+    }
+    return false;
+}
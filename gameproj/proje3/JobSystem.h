@@ -0,0 +1,78 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of threads for splitting a loop across cores. Each thread has
+// its own queue of pieces; a thread that runs out steals from the back of
+// another's queue, so uneven pieces still keep every core busy.
+class JobSystem {
+public:
+    // threadCount includes the calling thread; 1 runs everything inline.
+    // 0 picks one per core.
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned getThreadCount() const {
+        return static_cast<unsigned>(m_queues.size());
+    }
+
+    // Runs job(begin, end, thread) over [0, count) in pieces
+    // [k * grain, (k + 1) * grain), the last one cut short; thread is in
+    // [0, getThreadCount()). The caller works too and returns once every
+    // piece is done. Pieces run in no particular order; a job that needs an
+    // order should write per-piece results and merge them afterwards.
+    template <typename Job>
+    void parallelFor(std::size_t count, std::size_t grain, const Job& job) {
+        // Called through a plain function pointer so that no std::function
+        // has to allocate for a capturing lambda every tick.
+        run(count, grain, &invoke<Job>, &job);
+    }
+
+private:
+    typedef void (*Invoke)(const void* job, std::size_t begin, std::size_t end, unsigned thread);
+
+    template <typename Job>
+    static void invoke(const void* job, std::size_t begin, std::size_t end, unsigned thread) {
+        (*static_cast<const Job*>(job))(begin, end, thread);
+    }
+
+    // A thread's share of the pieces is the contiguous run [next, end):
+    // the owner takes from next, thieves from end.
+    struct Queue {
+        std::mutex mutex;
+        std::size_t next = 0;
+        std::size_t end = 0;
+    };
+
+    void run(std::size_t count, std::size_t grain, Invoke invoke, const void* job);
+    void workerLoop(unsigned index);
+    void runPieces(unsigned index);
+    bool popPiece(unsigned index, std::size_t& piece);
+    bool stealPiece(unsigned index, std::size_t& piece);
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // [0] belongs to the caller
+    std::vector<std::thread> m_workers;
+    Invoke m_invoke = nullptr;
+    const void* m_job = nullptr;
+    std::size_t m_count = 0;
+    std::size_t m_grain = 1;
+    std::atomic<std::size_t> m_remaining;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    unsigned m_generation = 0;
+    bool m_stopping = false;
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,173 @@
+#include "Level.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+// Whether indices holds count tile indices below tileCount, in ascending
+// order.
+bool validIndices(const std::uint32_t* indices, std::size_t count, std::size_t tileCount) {
+    for (std::size_t i = 0; i < count; ++i) {
+        if (indices[i] >= tileCount || (i > 0 && indices[i] <= indices[i - 1])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+void Level::clear() {
+    m_view = LevelView();
+    m_x.clear();
+    m_y.clear();
+    m_tileNumber.clear();
+    m_collision.clear();
+    m_crowns.clear();
+    m_file.close();
+}
+
+bool Level::loadText(const std::string& filePath) {
+    clear();
+
+    std::ifstream file(filePath);
+    if (!file) {
+        return false;
+    }
+
+    // Each tile is classified as it is read, with one table lookup
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        int x, y, tileNumber;
+        if (iss >> x >> y >> tileNumber) {
+            m_x.push_back(x);
+            m_y.push_back(y);
+            m_tileNumber.push_back(tileNumber);
+            classify(static_cast<std::uint32_t>(m_tileNumber.size() - 1));
+        }
+    }
+
+    updateView();
+    return true;
+}
+
+void Level::assign(std::vector<std::int32_t> x, std::vector<std::int32_t> y, std::vector<std::int32_t> tileNumber) {
+    clear();
+    m_x = std::move(x);
+    m_y = std::move(y);
+    m_tileNumber = std::move(tileNumber);
+    for (std::size_t i = 0; i < m_tileNumber.size(); ++i) {
+        classify(static_cast<std::uint32_t>(i));
+    }
+    updateView();
+}
+
+void Level::classify(std::uint32_t index) {
+    TileType type = tileType(m_tileNumber[index]);
+    if (type.isSolid()) {
+        m_collision.push_back(index);
+    }
+    if (type.isGoal()) {
+        m_crowns.push_back(index);
+    }
+}
+
+void Level::updateView() {
+    m_view.tileCount = m_tileNumber.size();
+    m_view.x = m_x.data();
+    m_view.y = m_y.data();
+    m_view.tileNumber = m_tileNumber.data();
+    m_view.collisionCount = m_collision.size();
+    m_view.collision = m_collision.data();
+    m_view.crownCount = m_crowns.size();
+    m_view.crowns = m_crowns.data();
+}
+
+bool Level::loadBinary(const std::string& filePath) {
+    clear();
+
+    if (!m_file.open(filePath)) {
+        return false;
+    }
+
+    const unsigned char* data = m_file.data();
+    std::size_t size = m_file.size();
+
+    LevelFileHeader header;
+    if (size < sizeof(header)) {
+        std::cerr << "Level file " << filePath << " is truncated" << std::endl;
+        clear();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, LEVEL_FILE_MAGIC, sizeof(header.magic)) != 0 || header.version != LEVEL_FILE_VERSION) {
+        std::cerr << "Level file " << filePath << " has an unknown format" << std::endl;
+        clear();
+        return false;
+    }
+
+    if (header.collisionCount > header.tileCount || header.crownCount > header.tileCount) {
+        std::cerr << "Level file " << filePath << " lists more solid or goal tiles than tiles" << std::endl;
+        clear();
+        return false;
+    }
+
+    std::size_t expected = sizeof(header)
+        + std::size_t(header.tileCount) * 3 * sizeof(std::int32_t)
+        + (std::size_t(header.collisionCount) + header.crownCount) * sizeof(std::uint32_t);
+    if (size < expected) {
+        std::cerr << "Level file " << filePath << " is truncated" << std::endl;
+        clear();
+        return false;
+    }
+
+    const std::int32_t* tiles = reinterpret_cast<const std::int32_t*>(data + sizeof(header));
+    const std::uint32_t* lists = reinterpret_cast<const std::uint32_t*>(tiles + std::size_t(header.tileCount) * 3);
+
+    // Everything downstream indexes the tile arrays with these as they are
+    if (!validIndices(lists, header.collisionCount, header.tileCount)
+        || !validIndices(lists + header.collisionCount, header.crownCount, header.tileCount)) {
+        std::cerr << "Level file " << filePath << " has a bad tile index" << std::endl;
+        clear();
+        return false;
+    }
+
+    m_view.tileCount = header.tileCount;
+    m_view.x = tiles;
+    m_view.y = tiles + header.tileCount;
+    m_view.tileNumber = tiles + std::size_t(header.tileCount) * 2;
+    m_view.collisionCount = header.collisionCount;
+    m_view.collision = lists;
+    m_view.crownCount = header.crownCount;
+    m_view.crowns = lists + header.collisionCount;
+    return true;
+}
+
+bool Level::saveBinary(const std::string& filePath) const {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    LevelFileHeader header;
+    std::memcpy(header.magic, LEVEL_FILE_MAGIC, sizeof(header.magic));
+    header.version = LEVEL_FILE_VERSION;
+    header.tileCount = static_cast<std::uint32_t>(m_view.tileCount);
+    header.collisionCount = static_cast<std::uint32_t>(m_view.collisionCount);
+    header.crownCount = static_cast<std::uint32_t>(m_view.crownCount);
+    header.reserved = 0;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(m_view.x), m_view.tileCount * sizeof(std::int32_t));
+    file.write(reinterpret_cast<const char*>(m_view.y), m_view.tileCount * sizeof(std::int32_t));
+    file.write(reinterpret_cast<const char*>(m_view.tileNumber), m_view.tileCount * sizeof(std::int32_t));
+    file.write(reinterpret_cast<const char*>(m_view.collision), m_view.collisionCount * sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char*>(m_view.crowns), m_view.crownCount * sizeof(std::uint32_t));
+    return static_cast<bool>(file);
+}
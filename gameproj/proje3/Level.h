@@ -0,0 +1,81 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "TileTypes.h"
+
+// Tile layout shared by the text and binary loaders. x/y/tileNumber are
+// parallel arrays of tileCount entries; collision and crowns hold ascending
+// indices into them: the solid (see TileType) and goal tiles.
+struct LevelView {
+    std::size_t tileCount = 0;
+    const std::int32_t* x = nullptr;
+    const std::int32_t* y = nullptr;
+    const std::int32_t* tileNumber = nullptr;
+
+    std::size_t collisionCount = 0;
+    const std::uint32_t* collision = nullptr;
+
+    std::size_t crownCount = 0;
+    const std::uint32_t* crowns = nullptr;
+};
+
+// Binary level file: this header followed by the x, y and tileNumber arrays
+// (int32, tileCount each), then the collision and crown index arrays
+// (uint32). Everything is little endian and 4-byte aligned so the loader can
+// point straight into the mapped file.
+struct LevelFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t tileCount;
+    std::uint32_t collisionCount;
+    std::uint32_t crownCount;
+    std::uint32_t reserved;
+};
+
+const char LEVEL_FILE_MAGIC[4] = { 'L', 'V', 'L', 'B' };
+const std::uint32_t LEVEL_FILE_VERSION = 1;
+
+class Level {
+public:
+    // Parses the "x y tileNumber" per line text format.
+    bool loadText(const std::string& filePath);
+
+    // Maps a file written by saveBinary. Only the collision and crown
+    // indices are checked; there is no other per-tile work.
+    bool loadBinary(const std::string& filePath);
+
+    bool saveBinary(const std::string& filePath) const;
+
+    // Takes parallel x/y/tileNumber arrays, e.g. a part of another level,
+    // and classifies them like loadText.
+    void assign(std::vector<std::int32_t> x, std::vector<std::int32_t> y, std::vector<std::int32_t> tileNumber);
+
+    const LevelView& view() const {
+        return m_view;
+    }
+
+private:
+    void clear();
+
+    // Adds tile index to the collision and crown lists it belongs in.
+    void classify(std::uint32_t index);
+    void updateView();
+
+    LevelView m_view;
+
+    // Backing storage for the text path; the binary path points into m_file.
+    std::vector<std::int32_t> m_x;
+    std::vector<std::int32_t> m_y;
+    std::vector<std::int32_t> m_tileNumber;
+    std::vector<std::uint32_t> m_collision;
+    std::vector<std::uint32_t> m_crowns;
+    MappedFile m_file;
+};
+
+#endif // LEVEL_H
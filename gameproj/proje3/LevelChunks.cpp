@@ -0,0 +1,232 @@
+#include "LevelChunks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+// Rounds towards negative infinity, so that chunk -1 holds x = -1.
+int floorDiv(int value, int divisor) {
+    int quotient = value / divisor;
+    if (value % divisor != 0 && value < 0) {
+        quotient--;
+    }
+    return quotient;
+}
+
+// Whether the chunk range in header is the one write() gives for its tile
+// extent, so that a corrupt index cannot ask for a huge presence table.
+// An empty level has no chunks at all.
+bool consistentRange(const ChunkIndexHeader& header) {
+    if (header.chunkSize > static_cast<std::uint32_t>(std::numeric_limits<int>::max())) {
+        return false;
+    }
+    if (header.cols == 0 || header.rows == 0) {
+        return header.cols == 0 && header.rows == 0;
+    }
+    if (header.left > header.right || header.top > header.bottom) {
+        return false;
+    }
+    int chunkSize = static_cast<int>(header.chunkSize);
+    int minX = floorDiv(header.left, chunkSize);
+    int minY = floorDiv(header.top, chunkSize);
+    long long cols = static_cast<long long>(floorDiv(header.right, chunkSize)) - minX + 1;
+    long long rows = static_cast<long long>(floorDiv(header.bottom, chunkSize)) - minY + 1;
+    return header.firstX == minX && header.firstY == minY && header.cols == cols && header.rows == rows
+        && cols <= std::numeric_limits<int>::max() && rows <= std::numeric_limits<int>::max();
+}
+
+std::string chunkFile(const std::string& directory, int x, int y) {
+    return directory + "/" + std::to_string(x) + "_" + std::to_string(y) + ".lvl";
+}
+
+}
+
+const char* const LevelChunks::CHUNK_INDEX_FILE = "index.lvc";
+
+bool LevelChunks::write(const LevelView& level, int chunkSize, const std::string& directory) {
+    if (chunkSize <= 0) {
+        std::cerr << "Chunk size must be positive" << std::endl;
+        return false;
+    }
+
+    ChunkIndexHeader header;
+    std::memcpy(header.magic, CHUNK_INDEX_MAGIC, sizeof(header.magic));
+    header.version = CHUNK_INDEX_VERSION;
+    header.chunkSize = static_cast<std::uint32_t>(chunkSize);
+    header.firstX = 0;
+    header.firstY = 0;
+    header.cols = 0;
+    header.rows = 0;
+    header.left = 0;
+    header.top = 0;
+    header.right = 0;
+    header.bottom = 0;
+    header.reserved = 0;
+
+    // Which chunk each tile is in, then the tiles of every chunk in level
+    // order so each chunk file keeps the original draw order.
+    std::vector<std::uint32_t> tileChunk(level.tileCount);
+    std::vector<std::uint32_t> chunkStart;
+    if (level.tileCount > 0) {
+        header.left = header.right = level.x[0];
+        header.top = header.bottom = level.y[0];
+        for (std::size_t i = 1; i < level.tileCount; ++i) {
+            header.left = std::min(header.left, level.x[i]);
+            header.top = std::min(header.top, level.y[i]);
+            header.right = std::max(header.right, level.x[i]);
+            header.bottom = std::max(header.bottom, level.y[i]);
+        }
+        int minX = floorDiv(header.left, chunkSize);
+        int minY = floorDiv(header.top, chunkSize);
+        int maxX = floorDiv(header.right, chunkSize);
+        int maxY = floorDiv(header.bottom, chunkSize);
+        header.firstX = minX;
+        header.firstY = minY;
+        header.cols = static_cast<std::uint32_t>(maxX - minX + 1);
+        header.rows = static_cast<std::uint32_t>(maxY - minY + 1);
+
+        chunkStart.assign(std::size_t(header.cols) * header.rows + 1, 0);
+        for (std::size_t i = 0; i < level.tileCount; ++i) {
+            int cx = floorDiv(level.x[i], chunkSize) - minX;
+            int cy = floorDiv(level.y[i], chunkSize) - minY;
+            tileChunk[i] = static_cast<std::uint32_t>(cy * header.cols + cx);
+            chunkStart[tileChunk[i] + 1]++;
+        }
+        for (std::size_t c = 1; c < chunkStart.size(); ++c) {
+            chunkStart[c] += chunkStart[c - 1];
+        }
+    }
+
+    std::vector<std::uint32_t> order(level.tileCount);
+    std::vector<std::uint32_t> next(chunkStart.begin(), chunkStart.empty() ? chunkStart.end() : chunkStart.end() - 1);
+    for (std::size_t i = 0; i < level.tileCount; ++i) {
+        order[next[tileChunk[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    std::vector<std::uint8_t> present(std::size_t(header.cols) * header.rows, 0);
+    for (std::size_t c = 0; c < present.size(); ++c) {
+        if (chunkStart[c] == chunkStart[c + 1]) {
+            continue;
+        }
+
+        std::vector<std::int32_t> x;
+        std::vector<std::int32_t> y;
+        std::vector<std::int32_t> tileNumber;
+        for (std::uint32_t t = chunkStart[c]; t < chunkStart[c + 1]; ++t) {
+            x.push_back(level.x[order[t]]);
+            y.push_back(level.y[order[t]]);
+            tileNumber.push_back(level.tileNumber[order[t]]);
+        }
+        Level chunk;
+        chunk.assign(std::move(x), std::move(y), std::move(tileNumber));
+
+        int cx = header.firstX + static_cast<int>(c % header.cols);
+        int cy = header.firstY + static_cast<int>(c / header.cols);
+        std::string path = chunkFile(directory, cx, cy);
+        if (!chunk.saveBinary(path)) {
+            std::cerr << "Could not write " << path << std::endl;
+            return false;
+        }
+        present[c] = 1;
+    }
+
+    std::string indexPath = directory + "/" + CHUNK_INDEX_FILE;
+    std::ofstream file(indexPath, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(present.data()), present.size());
+    if (!file) {
+        std::cerr << "Could not write " << indexPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LevelChunks::open(const std::string& directory) {
+    m_directory = directory;
+    m_chunkSize = 0;
+    m_first = ChunkCoord();
+    m_cols = 0;
+    m_rows = 0;
+    m_left = m_top = m_right = m_bottom = 0;
+    m_present.clear();
+
+    std::string indexPath = directory + "/" + CHUNK_INDEX_FILE;
+    std::ifstream file(indexPath, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    ChunkIndexHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        std::cerr << "Chunk index " << indexPath << " is truncated" << std::endl;
+        return false;
+    }
+    if (std::memcmp(header.magic, CHUNK_INDEX_MAGIC, sizeof(header.magic)) != 0 || header.version != CHUNK_INDEX_VERSION ||
+        header.chunkSize == 0) {
+        std::cerr << "Chunk index " << indexPath << " has an unknown format" << std::endl;
+        return false;
+    }
+
+    if (!consistentRange(header)) {
+        std::cerr << "Chunk index " << indexPath << " has a bad chunk range" << std::endl;
+        return false;
+    }
+
+    // Checked before the table is allocated, which the range alone still
+    // allows to be large
+    std::size_t tableSize = std::size_t(header.cols) * header.rows;
+    std::streampos tableStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - tableStart;
+    file.seekg(tableStart);
+    if (remaining < 0 || static_cast<std::size_t>(remaining) < tableSize) {
+        std::cerr << "Chunk index " << indexPath << " is truncated" << std::endl;
+        return false;
+    }
+
+    std::vector<std::uint8_t> present(tableSize);
+    if (!file.read(reinterpret_cast<char*>(present.data()), present.size())) {
+        std::cerr << "Chunk index " << indexPath << " is truncated" << std::endl;
+        return false;
+    }
+
+    m_chunkSize = static_cast<int>(header.chunkSize);
+    m_first.x = header.firstX;
+    m_first.y = header.firstY;
+    m_cols = static_cast<int>(header.cols);
+    m_rows = static_cast<int>(header.rows);
+    m_left = header.left;
+    m_top = header.top;
+    m_right = header.right;
+    m_bottom = header.bottom;
+    m_present.swap(present);
+    return true;
+}
+
+bool LevelChunks::hasChunk(const ChunkCoord& chunk) const {
+    int cx = chunk.x - m_first.x;
+    int cy = chunk.y - m_first.y;
+    if (cx < 0 || cy < 0 || cx >= m_cols || cy >= m_rows) {
+        return false;
+    }
+    return m_present[std::size_t(cy) * m_cols + cx] != 0;
+}
+
+std::string LevelChunks::chunkPath(const ChunkCoord& chunk) const {
+    return chunkFile(m_directory, chunk.x, chunk.y);
+}
+
+ChunkCoord LevelChunks::chunkAt(float x, float y) const {
+    ChunkCoord chunk;
+    if (m_chunkSize > 0) {
+        chunk.x = static_cast<int>(std::floor(x / m_chunkSize));
+        chunk.y = static_cast<int>(std::floor(y / m_chunkSize));
+    }
+    return chunk;
+}
@@ -0,0 +1,111 @@
+#ifndef LEVELCHUNKS_H
+#define LEVELCHUNKS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Level.h"
+
+// Chunk coordinates: chunk (x, y) covers the pixels from x * chunkSize to
+// (x + 1) * chunkSize, likewise for y. A tile belongs to the chunk its
+// top-left corner is in.
+struct ChunkCoord {
+    int x = 0;
+    int y = 0;
+};
+
+inline bool operator==(const ChunkCoord& a, const ChunkCoord& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+inline bool operator!=(const ChunkCoord& a, const ChunkCoord& b) {
+    return !(a == b);
+}
+
+// Index of a chunked level: this header followed by cols * rows bytes, row
+// major from firstX/firstY, that are 1 where the chunk has a file. Little
+// endian like the level files.
+struct ChunkIndexHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t chunkSize; // chunk edge in pixels
+    std::int32_t firstX;
+    std::int32_t firstY;
+    std::uint32_t cols;
+    std::uint32_t rows;
+    std::int32_t left; // extent of the tiles' top-left corners
+    std::int32_t top;
+    std::int32_t right;
+    std::int32_t bottom;
+    std::uint32_t reserved;
+};
+
+const char CHUNK_INDEX_MAGIC[4] = { 'L', 'V', 'L', 'C' };
+const std::uint32_t CHUNK_INDEX_VERSION = 1;
+
+// A level split into square chunks so that it can be streamed: a directory
+// holding CHUNK_INDEX_FILE and one binary level file per non-empty chunk,
+// named "<x>_<y>.lvl" after its chunk coordinates.
+class LevelChunks {
+public:
+    static const char* const CHUNK_INDEX_FILE;
+
+    // Splits level into chunkSize pixel chunks and writes them and the
+    // index into directory, which must exist.
+    static bool write(const LevelView& level, int chunkSize, const std::string& directory);
+
+    // Reads the index of a directory written by write().
+    bool open(const std::string& directory);
+
+    int getChunkSize() const {
+        return m_chunkSize;
+    }
+
+    // The chunk range the index covers; chunks outside it are all empty.
+    ChunkCoord getFirst() const {
+        return m_first;
+    }
+    int getCols() const {
+        return m_cols;
+    }
+    int getRows() const {
+        return m_rows;
+    }
+
+    // Smallest and largest tile corner in the level; the tiles themselves
+    // reach a tile further right and down.
+    int getLeft() const {
+        return m_left;
+    }
+    int getTop() const {
+        return m_top;
+    }
+    int getRight() const {
+        return m_right;
+    }
+    int getBottom() const {
+        return m_bottom;
+    }
+
+    bool hasChunk(const ChunkCoord& chunk) const;
+
+    // File holding chunk, whether or not it exists.
+    std::string chunkPath(const ChunkCoord& chunk) const;
+
+    ChunkCoord chunkAt(float x, float y) const;
+
+private:
+    std::string m_directory;
+    int m_chunkSize = 0;
+    ChunkCoord m_first;
+    int m_cols = 0;
+    int m_rows = 0;
+    int m_left = 0;
+    int m_top = 0;
+    int m_right = 0;
+    int m_bottom = 0;
+    std::vector<std::uint8_t> m_present;
+};
+
+#endif // LEVELCHUNKS_H
@@ -0,0 +1,96 @@
+#include "ParallaxBackground.h"
+
+#include <string>
+
+bool ParallaxBackground::addLayer(std::shared_ptr<sf::Texture> texture, float scroll, const sf::Vector2f& repeatSize) {
+    if (!texture || m_layers.size() == MAX_LAYERS || repeatSize.x <= 0 || repeatSize.y <= 0) {
+        return false;
+    }
+    texture->setRepeated(true);
+    m_layers.push_back(Layer{texture, scroll, repeatSize});
+    m_ready = false;
+    return true;
+}
+
+bool ParallaxBackground::loadShader() {
+    if (!sf::Shader::isAvailable()) {
+        return false;
+    }
+
+    // The quad's texture coordinates are view pixels; each layer adds its
+    // share of the view's position and blends over the ones behind it.
+    std::string declarations = "uniform vec2 viewOrigin;\n";
+    std::string body = "    vec2 screen = gl_TexCoord[0].xy;\n"
+                       "    vec4 color = vec4(0.0);\n"
+                       "    vec4 layer;\n";
+    for (std::size_t i = 0; i < m_layers.size(); ++i) {
+        std::string n = std::to_string(i);
+        declarations += "uniform sampler2D texture" + n + ";\n"
+                        "uniform float scroll" + n + ";\n"
+                        "uniform vec2 repeatSize" + n + ";\n";
+        body += "    layer = texture2D(texture" + n + ", (viewOrigin * scroll" + n + " + screen) / repeatSize" + n + ");\n"
+                "    color = vec4(mix(color.rgb, layer.rgb, layer.a), layer.a + color.a * (1.0 - layer.a));\n";
+    }
+    std::string source = declarations + "void main() {\n" + body + "    gl_FragColor = color;\n}\n";
+    if (!m_shader.loadFromMemory(source, sf::Shader::Fragment)) {
+        return false;
+    }
+
+    // Only the view's position changes from frame to frame
+    for (std::size_t i = 0; i < m_layers.size(); ++i) {
+        std::string n = std::to_string(i);
+        m_shader.setUniform("texture" + n, *m_layers[i].texture);
+        m_shader.setUniform("scroll" + n, m_layers[i].scroll);
+        m_shader.setUniform("repeatSize" + n, m_layers[i].repeatSize);
+    }
+    return true;
+}
+
+unsigned ParallaxBackground::draw(sf::RenderTarget& target) {
+    if (m_layers.empty()) {
+        return 0;
+    }
+    if (!m_ready) {
+        for (const Layer& layer : m_layers) {
+            if (layer.texture->getSize().x == 0) {
+                return 0; // still loading
+            }
+        }
+        m_ready = true;
+        m_shaderLoaded = loadShader();
+    }
+
+    const sf::View& view = target.getView();
+    sf::Vector2f size = view.getSize();
+    sf::Vector2f origin = view.getCenter() - size / 2.f;
+
+    sf::Vertex quad[4];
+    quad[0].position = origin;
+    quad[1].position = sf::Vector2f(origin.x + size.x, origin.y);
+    quad[2].position = origin + size;
+    quad[3].position = sf::Vector2f(origin.x, origin.y + size.y);
+
+    if (m_shaderLoaded) {
+        quad[0].texCoords = sf::Vector2f(0, 0);
+        quad[1].texCoords = sf::Vector2f(size.x, 0);
+        quad[2].texCoords = size;
+        quad[3].texCoords = sf::Vector2f(0, size.y);
+
+        m_shader.setUniform("viewOrigin", origin);
+        target.draw(quad, 4, sf::Quads, sf::RenderStates(&m_shader));
+        return 1;
+    }
+
+    // Same picture a layer at a time; the repeating texture tiles the quad
+    for (const Layer& layer : m_layers) {
+        sf::Vector2f textureSize(layer.texture->getSize());
+        sf::Vector2f scale(textureSize.x / layer.repeatSize.x, textureSize.y / layer.repeatSize.y);
+        sf::Vector2f start = origin * layer.scroll;
+        for (int v = 0; v < 4; ++v) {
+            sf::Vector2f offset = quad[v].position - origin + start;
+            quad[v].texCoords = sf::Vector2f(offset.x * scale.x, offset.y * scale.y);
+        }
+        target.draw(quad, 4, sf::Quads, sf::RenderStates(layer.texture.get()));
+    }
+    return static_cast<unsigned>(m_layers.size());
+}
@@ -0,0 +1,49 @@
+#ifndef PARALLAXBACKGROUND_H
+#define PARALLAXBACKGROUND_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Background layers that scroll slower than the level, back to front. Every
+// layer's texture repeats, and one full-view quad is drawn with a fragment
+// shader that works out each layer's texture offset from the view's
+// position, so a frame costs one uniform and one draw call however many
+// layers there are. Without shader support each layer is drawn as a quad of
+// its own instead.
+class ParallaxBackground {
+public:
+    // Fragment shader samplers; more layers than this are refused.
+    static const std::size_t MAX_LAYERS = 8;
+
+    // scroll is how far the layer moves per pixel the view moves: 1 moves
+    // with the level, 0 stays on screen. One copy of the texture covers
+    // repeatSize world pixels. The texture is set to repeat.
+    bool addLayer(std::shared_ptr<sf::Texture> texture, float scroll, const sf::Vector2f& repeatSize);
+
+    std::size_t getLayerCount() const {
+        return m_layers.size();
+    }
+
+    // Fills target's view and returns the number of draw calls. Nothing is
+    // drawn until every layer's texture has loaded.
+    unsigned draw(sf::RenderTarget& target);
+
+private:
+    struct Layer {
+        std::shared_ptr<sf::Texture> texture;
+        float scroll;
+        sf::Vector2f repeatSize;
+    };
+
+    // Compiles the shader for the current layers, once they have loaded.
+    bool loadShader();
+
+    std::vector<Layer> m_layers;
+    bool m_ready = false; // every texture loaded, shader compiled or not
+    bool m_shaderLoaded = false;
+    sf::Shader m_shader;
+};
+
+#endif // PARALLAXBACKGROUND_H
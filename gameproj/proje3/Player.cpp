@@ -0,0 +1,96 @@
+#include "Player.h"
+
+#include "GameConfig.h"
+#include "Systems.h"
+
+Player::Player(GameEntities& entities) : entities(entities), entity(entities.create()) {
+    reset();
+}
+
+void Player::reset() {
+    Velocity velocity;
+    velocity.value = sf::Vector2f(200.0f, 0.0f);
+    velocity.gravity = 981.0f; // gravity in pixels/s^2
+
+    Collider collider;
+    collider.size = sf::Vector2f(32, 32);
+    collider.layer = LAYER_PLAYER;
+    collider.sweepTiles = true;
+
+    // Each frame is 32x32 pixels: two on row 0 while walking, eight on row
+    // 5 in the air.
+    Animation animation;
+    animation.frameSize = sf::Vector2i(32, 32);
+    animation.groundRow = 0;
+    animation.groundFrames = 2;
+    animation.airRow = 5;
+    animation.airFrames = 8;
+    animation.frame = sf::IntRect(0, 0, 32, 32);
+
+    entities.add(entity, Transform());
+    entities.add(entity, velocity);
+    entities.add(entity, collider);
+    entities.add(entity, animation);
+    entities.add(entity, Control());
+    setPosition(PLAYER_SPAWN_X, PLAYER_SPAWN_Y);
+}
+
+sf::Vector2f Player::getPosition() const {
+    return entities.get<Transform>(entity).position;
+}
+
+sf::FloatRect Player::getBounds() const {
+    return colliderBounds(entities, entity);
+}
+
+void Player::setPosition(float x, float y) {
+    Transform& transform = entities.get<Transform>(entity);
+    transform.position = sf::Vector2f(x, y);
+    transform.previous = transform.position;
+}
+
+void Player::jump() {
+    Control& control = entities.get<Control>(entity);
+    if (control.jumpCount < control.maxJumps) {
+        entities.get<Velocity>(entity).value.y = -control.jumpSpeed;
+        entities.get<Collider>(entity).onGround = false;
+        control.jumpCount++;
+    }
+}
+
+void Player::moveLeft() {
+    entities.get<Velocity>(entity).value.x = -entities.get<Control>(entity).moveSpeed;
+    entities.get<Transform>(entity).facingLeft = true;
+}
+
+void Player::moveRight() {
+    entities.get<Velocity>(entity).value.x = entities.get<Control>(entity).moveSpeed;
+    entities.get<Transform>(entity).facingLeft = false;
+}
+
+void Player::stop() {
+    entities.get<Velocity>(entity).value.x = 0.0f;
+}
+
+void Player::caught() {
+    setPosition(PLAYER_SPAWN_X, PLAYER_SPAWN_Y);
+    Velocity& velocity = entities.get<Velocity>(entity);
+    velocity.value.y = 0;
+    velocity.value.x = entities.get<Control>(entity).moveSpeed;
+    entities.get<Control>(entity).jumpCount = 0;
+}
+
+void Player::snapshot(PlayerSnapshot& out) const {
+    const Transform& transform = entities.get<Transform>(entity);
+    out.frame = entities.get<Animation>(entity).frame;
+    out.position = transform.position;
+    out.previous = transform.previous;
+    out.facingLeft = transform.facingLeft;
+}
+
+void PlayerSnapshot::batch(SpriteBatch& batch, int layer, const TextureRegion& sheet, float alpha) const {
+    sf::Vector2f drawn = previous + (position - previous) * alpha;
+    sf::IntRect source(sheet.rect.left + frame.left, sheet.rect.top + frame.top, frame.width, frame.height);
+    sf::FloatRect rect(drawn.x, drawn.y, static_cast<float>(frame.width), static_cast<float>(frame.height));
+    batch.addQuad(sheet.texture, layer, rect, source, sf::Color::White, facingLeft);
+}
@@ -0,0 +1,58 @@
+#ifndef PLAYER_H
+#define PLAYER_H
+
+#include <SFML/Graphics.hpp>
+
+#include "Components.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+
+// What drawing the player needs from one tick, copied out of its components
+// so it can be drawn on another thread.
+struct PlayerSnapshot {
+    sf::IntRect frame; // cell of the animation sheet
+    sf::Vector2f position;
+    sf::Vector2f previous; // position at the start of the tick
+    bool facingLeft = false;
+
+    // Adds the player's quad to batch, cut from sheet (the animation sheet,
+    // possibly inside an atlas). alpha is how far the frame is between the
+    // previous and the current tick.
+    void batch(SpriteBatch& batch, int layer, const TextureRegion& sheet, float alpha) const;
+};
+
+// The player's entity and the controls acting on it. Its physics and
+// animation are done by the systems like for any other entity.
+class Player {
+public:
+    // Creates the player entity in entities, which must outlive the player.
+    explicit Player(GameEntities& entities);
+
+    Entity getEntity() const {
+        return entity;
+    }
+
+    sf::Vector2f getPosition() const;
+    sf::FloatRect getBounds() const;
+
+    // Moves the player without interpolating from the old position.
+    void setPosition(float x, float y);
+
+    void jump();
+    void moveLeft();
+    void moveRight();
+    void stop();
+    void caught();
+
+    // Everything back to how the player was created: at the spawn point,
+    // walking right, on the first animation frame.
+    void reset();
+
+    void snapshot(PlayerSnapshot& out) const;
+
+private:
+    GameEntities& entities;
+    Entity entity;
+};
+
+#endif // PLAYER_H
@@ -0,0 +1,42 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// PCG32 generator (O'Neill, pcg-random.org). Unlike std::rand its sequence
+// is the same with every standard library and it belongs to whoever owns
+// it, so a seeded run can be played again exactly.
+class Random {
+public:
+    explicit Random(std::uint64_t seed = 0) {
+        setSeed(seed);
+    }
+
+    void setSeed(std::uint64_t seed) {
+        m_state = 0;
+        next();
+        m_state += seed;
+        next();
+    }
+
+    std::uint32_t next() {
+        std::uint64_t old = m_state;
+        m_state = old * 6364136223846793005ULL + INCREMENT;
+        std::uint32_t shifted = static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+        std::uint32_t rotation = static_cast<std::uint32_t>(old >> 59u);
+        return (shifted >> rotation) | (shifted << ((32u - rotation) & 31u));
+    }
+
+    // In [0, bound), bound > 0. Scaled rather than taken modulo bound, so
+    // small bounds come out even.
+    std::uint32_t nextBelow(std::uint32_t bound) {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(next()) * bound) >> 32);
+    }
+
+private:
+    static const std::uint64_t INCREMENT = 1442695040888963407ULL;
+
+    std::uint64_t m_state;
+};
+
+#endif // RANDOM_H
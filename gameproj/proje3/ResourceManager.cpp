@@ -0,0 +1,209 @@
+#include "ResourceManager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+ResourceManager::ResourceManager(unsigned workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+    }
+    for (unsigned i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&ResourceManager::workerLoop, this);
+    }
+}
+
+ResourceManager::~ResourceManager() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_queueReady.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<sf::Texture> ResourceManager::requestTexture(const std::string& path) {
+    return request(path, false).texture;
+}
+
+std::shared_ptr<sf::Font> ResourceManager::requestFont(const std::string& path) {
+    return request(path, true).font;
+}
+
+ResourceManager::Asset& ResourceManager::request(const std::string& path, bool isFont) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_assets.find(path);
+    if (found != m_assets.end()) {
+        Asset& asset = *found->second;
+        if (asset.isFont != isFont) {
+            // The handle stays empty forever rather than being null
+            std::cerr << "Asset " << path << " requested as both a texture and a font" << std::endl;
+            if (isFont && !asset.font) {
+                asset.font = std::make_shared<sf::Font>();
+            } else if (!isFont && !asset.texture) {
+                asset.texture = std::make_shared<sf::Texture>();
+            }
+        }
+        return asset;
+    }
+
+    std::unique_ptr<Asset> asset(new Asset());
+    asset->path = path;
+    asset->isFont = isFont;
+    if (isFont) {
+        asset->font = std::make_shared<sf::Font>();
+    } else {
+        asset->texture = std::make_shared<sf::Texture>();
+    }
+
+    Asset& added = *asset;
+    m_assets[path] = std::move(asset);
+    m_queue.push_back(&added);
+    m_pending++;
+    m_queueReady.notify_one();
+    return added;
+}
+
+void ResourceManager::reload(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto found = m_assets.find(path);
+    if (found == m_assets.end() || found->second->isFont || found->second->state == ASSET_PENDING) {
+        return;
+    }
+
+    // An asset that failed before loads as if for the first time
+    Asset& asset = *found->second;
+    asset.reloading = asset.state == ASSET_READY;
+    asset.state = ASSET_PENDING;
+    asset.requested.restart();
+    m_queue.push_back(&asset);
+    m_pending++;
+    m_queueReady.notify_one();
+}
+
+void ResourceManager::workerLoop() {
+    while (true) {
+        Asset* asset;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_queueReady.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) {
+                return;
+            }
+            asset = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        // Only this worker touches the asset until it is handed back
+        sf::Clock clock;
+        bool ok;
+        if (asset->isFont) {
+            std::ifstream file(asset->path, std::ios::binary);
+            asset->fontData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            ok = !asset->fontData.empty();
+        } else {
+            ok = asset->image.loadFromFile(asset->path);
+        }
+        asset->readTime = clock.getElapsedTime().asSeconds() * 1000.0f;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            asset->decoded = ok;
+            m_done.push_back(asset);
+        }
+        m_doneReady.notify_all();
+    }
+}
+
+void ResourceManager::update() {
+    std::vector<Asset*> done;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done.swap(m_done);
+    }
+
+    for (Asset* asset : done) {
+        finish(*asset);
+    }
+}
+
+void ResourceManager::finish(Asset& asset) {
+    sf::Clock clock;
+    bool ok = asset.decoded;
+    if (ok && asset.isFont) {
+        ok = asset.font->loadFromMemory(asset.fontData.data(), asset.fontData.size());
+    }
+    if (ok && !asset.isFont) {
+        ok = asset.texture->loadFromImage(asset.image);
+        asset.image = sf::Image(); // the pixels live on the GPU now
+    }
+    if (!ok) {
+        std::cerr << "Could not load asset " << asset.path << (asset.reloading ? ", keeping the old one" : "") << std::endl;
+    }
+
+    AssetLoadInfo info;
+    info.path = asset.path;
+    info.loaded = ok;
+    info.readTime = asset.readTime;
+    info.uploadTime = clock.getElapsedTime().asSeconds() * 1000.0f;
+    info.totalTime = asset.requested.getElapsedTime().asSeconds() * 1000.0f;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        asset.state = ok || asset.reloading ? ASSET_READY : ASSET_FAILED;
+        asset.reloading = false;
+        m_pending--;
+    }
+
+    if (m_hook) {
+        m_hook(info);
+    }
+}
+
+AssetState ResourceManager::wait(const std::string& path) {
+    while (true) {
+        update();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto found = m_assets.find(path);
+        if (found == m_assets.end()) {
+            return ASSET_FAILED;
+        }
+        if (found->second->state != ASSET_PENDING) {
+            return found->second->state;
+        }
+        m_doneReady.wait(lock, [this] { return !m_done.empty(); });
+    }
+}
+
+void ResourceManager::waitAll() {
+    while (true) {
+        update();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_pending == 0) {
+            return;
+        }
+        m_doneReady.wait(lock, [this] { return !m_done.empty(); });
+    }
+}
+
+AssetState ResourceManager::getState(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_assets.find(path);
+    return found == m_assets.end() ? ASSET_FAILED : found->second->state;
+}
+
+std::size_t ResourceManager::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+void ResourceManager::setLoadHook(LoadHook hook) {
+    m_hook = hook;
+}
@@ -0,0 +1,105 @@
+#ifndef RESOURCEMANAGER_H
+#define RESOURCEMANAGER_H
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum AssetState {
+    ASSET_PENDING,
+    ASSET_READY,
+    ASSET_FAILED
+};
+
+// Timings of one finished asset, in milliseconds. readTime is spent on a
+// worker (file read and image decode), uploadTime on the main thread
+// (texture upload / font setup) and totalTime is from request to ready.
+struct AssetLoadInfo {
+    std::string path;
+    bool loaded = false;
+    float readTime = 0;
+    float uploadTime = 0;
+    float totalTime = 0;
+};
+
+// Texture and font cache shared by everything that draws. Files are read
+// and images decoded on worker threads; the GPU side is created on the
+// thread calling update(), which must be the one that owns the window.
+//
+// Requesting the same path twice returns the same handle. A texture
+// handle is empty (size 0x0) until its asset is ready, so sprites can be
+// set up with it right away and only look right once it has arrived.
+class ResourceManager {
+public:
+    typedef std::function<void(const AssetLoadInfo&)> LoadHook;
+
+    // workerCount 0 picks one per core, at most four.
+    explicit ResourceManager(unsigned workerCount = 0);
+    ~ResourceManager();
+
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    std::shared_ptr<sf::Texture> requestTexture(const std::string& path);
+    std::shared_ptr<sf::Font> requestFont(const std::string& path);
+
+    // Reads a texture again, e.g. after its file changed. The new pixels go
+    // into the same handle when update() finishes it; if the file cannot be
+    // read the old ones stay. Ignored for fonts, unknown paths and assets
+    // still loading.
+    void reload(const std::string& path);
+
+    // Finishes every asset the workers are done with. Never blocks.
+    void update();
+
+    // Blocks until path (or every requested asset) is ready or has failed.
+    AssetState wait(const std::string& path);
+    void waitAll();
+
+    AssetState getState(const std::string& path) const;
+    std::size_t getPendingCount() const;
+
+    // Called on the main thread once per finished asset.
+    void setLoadHook(LoadHook hook);
+
+private:
+    struct Asset {
+        std::string path;
+        bool isFont = false;
+        bool reloading = false;
+        AssetState state = ASSET_PENDING;
+        std::shared_ptr<sf::Texture> texture;
+        std::shared_ptr<sf::Font> font;
+
+        // Filled in by the worker
+        bool decoded = false;
+        sf::Image image;
+        std::vector<char> fontData; // sf::Font reads from it for its whole life
+        sf::Clock requested;
+        float readTime = 0;
+    };
+
+    Asset& request(const std::string& path, bool isFont);
+    void workerLoop();
+    void finish(Asset& asset);
+
+    std::map<std::string, std::unique_ptr<Asset>> m_assets;
+    std::deque<Asset*> m_queue;   // waiting for a worker
+    std::vector<Asset*> m_done;   // decoded, waiting for update()
+    std::size_t m_pending = 0;    // requested but not finished
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueReady;
+    std::condition_variable m_doneReady;
+    bool m_stopping = false;
+    std::vector<std::thread> m_workers;
+    LoadHook m_hook;
+};
+
+#endif // RESOURCEMANAGER_H
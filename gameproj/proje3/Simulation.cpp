@@ -0,0 +1,225 @@
+#include "Simulation.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "AllocationTracker.h"
+
+namespace {
+
+// Camera centre that follows the player but never shows outside the level.
+sf::Vector2f cameraCenter(const sf::Vector2f& playerPosition, const sf::FloatRect& level) {
+    sf::Vector2f center = playerPosition;
+    center.x = std::max(center.x, level.left + WINDOW_WIDTH / 2.0f);
+    center.x = std::min(center.x, level.left + level.width - WINDOW_WIDTH / 2.0f);
+    center.y = std::max(center.y, level.top + WINDOW_HEIGHT / 2.0f);
+    center.y = std::min(center.y, level.top + level.height - WINDOW_HEIGHT / 2.0f);
+    return center;
+}
+
+}
+
+float FrameSnapshot::alpha() const {
+    float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - time).count();
+    return std::min(1.0f, std::max(0.0f, elapsed / step));
+}
+
+Simulation::Simulation(World& world, float tickRate, int maxStepsPerFrame)
+    : m_world(world), m_timestep(tickRate, maxStepsPerFrame) {
+    m_world.setProfiler(&m_profiler);
+    m_viewCenter = cameraCenter(m_world.getPlayer().getPosition(), m_levelBounds);
+
+    // So that latest() has something to show before the first tick
+    m_profiler.beginFrame();
+    m_profiler.endFrame();
+    publish(m_profiler.getFrame(0), m_viewCenter);
+    m_snapshots.update();
+
+    m_thread = std::thread(&Simulation::run, this);
+}
+
+Simulation::~Simulation() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+    m_world.setProfiler(nullptr);
+}
+
+void Simulation::start(Difficulty difficulty, std::uint64_t seed) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_startRequested = true;
+        m_difficulty = difficulty;
+        m_seed = seed;
+    }
+    m_wake.notify_all();
+}
+
+void Simulation::setInput(const WorldInput& input) {
+    m_left = input.left;
+    m_right = input.right;
+    if (input.jump) {
+        m_jump = true;
+    }
+    if (input.stop) {
+        m_stop = true;
+    }
+}
+
+const FrameSnapshot& Simulation::latest() {
+    m_snapshots.update();
+    return m_snapshots.front();
+}
+
+void Simulation::requestRecordingSave(const std::string& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_recordingPath = filePath;
+    }
+    m_wake.notify_all();
+}
+
+void Simulation::setCollision(const TileCollision& collision) {
+    std::lock_guard<std::mutex> lock(m_worldMutex);
+    m_world.setCollision(collision);
+}
+
+void Simulation::setLevelBounds(const sf::FloatRect& bounds) {
+    std::lock_guard<std::mutex> lock(m_worldMutex);
+    m_levelBounds = bounds;
+}
+
+void Simulation::setAllocationTrap(bool armed) {
+    m_allocationTrap = armed;
+}
+
+void Simulation::requestProfileDump(const std::string& basePath) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_profileDumpPath = basePath;
+    }
+    m_wake.notify_all();
+}
+
+void Simulation::run() {
+    typedef std::chrono::steady_clock Clock;
+
+    bool running = false;
+    Clock::time_point last = Clock::now();
+
+    while (true) {
+        bool started = false;
+        std::string dumpPath;
+        std::string recordingPath;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!running) {
+                m_wake.wait(lock, [this] {
+                    return m_quit || m_startRequested || !m_profileDumpPath.empty() || !m_recordingPath.empty();
+                });
+            }
+            if (m_quit) {
+                return;
+            }
+            if (m_startRequested) {
+                m_startRequested = false;
+                {
+                    // The main thread can swap the collision or the bounds
+                    // meanwhile, same as during ticks
+                    std::lock_guard<std::mutex> worldLock(m_worldMutex);
+                    m_world.start(m_difficulty, m_seed);
+                    m_viewCenter = cameraCenter(m_world.getPlayer().getPosition(), m_levelBounds);
+                }
+                m_recording.begin(m_difficulty, m_seed, m_timestep.getStep());
+                m_timestep.reset();
+                m_tick = 0;
+                m_jump = false;
+                m_stop = false;
+                running = true;
+                started = true;
+                last = Clock::now();
+            }
+            dumpPath.swap(m_profileDumpPath);
+            recordingPath.swap(m_recordingPath);
+        }
+
+        if (!dumpPath.empty()) {
+            m_profiler.writeCsv(dumpPath + ".csv");
+            m_profiler.writeChromeTrace(dumpPath + ".json");
+        }
+        if (!recordingPath.empty() && !m_recording.save(recordingPath)) {
+            std::cerr << "Could not write " << recordingPath << std::endl;
+        }
+        if (!running) {
+            continue;
+        }
+
+        m_profiler.beginFrame();
+        Clock::time_point now = Clock::now();
+        int steps = m_timestep.advance(std::chrono::duration<float>(now - last).count());
+        last = now;
+
+        sf::Vector2f previousViewCenter = m_viewCenter;
+        bool won = false;
+        std::unique_lock<std::mutex> worldLock(m_worldMutex);
+        // Room for this pass's input is made before the trap is armed
+        m_recording.reserveAhead(static_cast<std::size_t>(steps));
+        {
+            NoAllocationScope allocationScope(m_allocationTrap && m_tick >= ALLOCATION_WARMUP_TICKS);
+            for (int step = 0; step < steps; ++step) {
+                // Edges only apply to the first tick that sees them
+                WorldInput input;
+                input.left = m_left;
+                input.right = m_right;
+                input.jump = m_jump.exchange(false);
+                input.stop = m_stop.exchange(false);
+                m_recording.record(input);
+
+                if (m_world.tick(m_timestep.getStep(), input)) {
+                    won = true;
+                    break;
+                }
+                m_tick++;
+                previousViewCenter = m_viewCenter;
+                m_viewCenter = cameraCenter(m_world.getPlayer().getPosition(), m_levelBounds);
+            }
+        }
+        worldLock.unlock();
+        m_profiler.endFrame();
+
+        if (won) {
+            m_wins++;
+            running = false;
+        }
+        if (steps > 0 || started) {
+            publish(m_profiler.getFrame(m_profiler.getFrameCount() - 1), previousViewCenter);
+        }
+
+        if (running) {
+            // Sleep until the next tick is due
+            float wait = (1.0f - m_timestep.getAlpha()) * m_timestep.getStep();
+            std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+        }
+    }
+}
+
+void Simulation::publish(const FrameSample& profile, const sf::Vector2f& previousViewCenter) {
+    FrameSnapshot& snapshot = m_snapshots.back();
+    const Player& player = m_world.getPlayer();
+
+    snapshot.tick = m_tick;
+    snapshot.time = std::chrono::steady_clock::now();
+    snapshot.step = m_timestep.getStep();
+    player.snapshot(snapshot.player);
+    m_world.getAttacker().snapshot(snapshot.ghosts);
+    snapshot.viewCenter = m_viewCenter;
+    snapshot.previousViewCenter = previousViewCenter;
+    snapshot.heightMarker = static_cast<int>(player.getPosition().y) / 100;
+    snapshot.wins = m_wins;
+    snapshot.simFrame = profile;
+
+    m_snapshots.publish();
+}
@@ -0,0 +1,129 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Attacker.h"
+#include "FixedTimestep.h"
+#include "FrameProfiler.h"
+#include "GameConfig.h"
+#include "InputRecording.h"
+#include "Player.h"
+#include "TripleBuffer.h"
+#include "World.h"
+
+// Everything the render thread needs from one simulated tick. Published
+// whole and never changed afterwards.
+struct FrameSnapshot {
+    std::uint64_t tick = 0; // ticks since the round started
+    std::chrono::steady_clock::time_point time; // when the tick finished
+    float step = 1.0f / SIM_TICK_RATE;
+
+    PlayerSnapshot player;
+    GhostSnapshot ghosts;
+
+    // Camera centre after this tick and the one before, clamped to the level
+    sf::Vector2f viewCenter;
+    sf::Vector2f previousViewCenter;
+
+    int heightMarker = 0; // what the HUD shows after "Y: "
+    unsigned wins = 0;    // crowns reached since the simulation was created
+
+    FrameSample simFrame; // profile of the simulation loop pass that made it
+
+    // How far now is between the previous and this tick, 0-1.
+    float alpha() const;
+};
+
+// Ticks a round runs before the allocation trap is armed: enough for the
+// ghost pool and the world's scratch storage to reach their size.
+const std::uint64_t ALLOCATION_WARMUP_TICKS = 120;
+
+// Runs a World on its own thread at a fixed rate. The window thread sends
+// input and start requests and draws the newest snapshot; it must not touch
+// the World itself while the simulation exists.
+class Simulation {
+public:
+    // Takes over world, which must outlive the simulation.
+    Simulation(World& world, float tickRate, int maxStepsPerFrame);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Starts a new round from seed. Ticking stops again by itself when the
+    // player reaches a crown (the snapshot's wins goes up).
+    void start(Difficulty difficulty, std::uint64_t seed);
+
+    // left/right are held keys; jump and stop are kept until a tick sees them.
+    void setInput(const WorldInput& input);
+
+    // Newest published snapshot. Never blocks; the reference stays valid
+    // until the next call.
+    const FrameSnapshot& latest();
+
+    // Has the world collide with collision from its next tick on. Waits for
+    // the simulation thread to finish the ticks it is running, so the old
+    // collision may be destroyed as soon as this returns.
+    void setCollision(const TileCollision& collision);
+
+    // Area the camera stays in, GAME_WIDTH x GAME_HEIGHT from the origin
+    // unless set. Takes effect from the next tick on.
+    void setLevelBounds(const sf::FloatRect& bounds);
+
+    // While armed, every tick past the first ALLOCATION_WARMUP_TICKS of a
+    // round runs in a NoAllocationScope on the simulation thread.
+    void setAllocationTrap(bool armed);
+
+    // Writes the simulation thread's profile to <basePath>.csv and .json.
+    void requestProfileDump(const std::string& basePath);
+
+    // Writes the input of the current (or last) round to filePath, see
+    // InputRecording. replay() on it plays the round again.
+    void requestRecordingSave(const std::string& filePath);
+
+private:
+    void run();
+    void publish(const FrameSample& profile, const sf::Vector2f& previousViewCenter);
+
+    World& m_world;
+    FixedTimestep m_timestep;
+    FrameProfiler m_profiler; // only touched by the simulation thread
+    TripleBuffer<FrameSnapshot> m_snapshots;
+    std::uint64_t m_tick = 0;
+    unsigned m_wins = 0;
+    sf::Vector2f m_viewCenter;
+    sf::FloatRect m_levelBounds{0, 0, GAME_WIDTH, GAME_HEIGHT}; // guarded by m_worldMutex
+    InputRecording m_recording; // only touched by the simulation thread
+
+    std::atomic<bool> m_left{false};
+    std::atomic<bool> m_right{false};
+    std::atomic<bool> m_jump{false};
+    std::atomic<bool> m_stop{false};
+    std::atomic<bool> m_allocationTrap{false};
+
+    // Requests from the window thread
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit = false;
+    bool m_startRequested = false;
+    Difficulty m_difficulty = NORMAL;
+    std::uint64_t m_seed = 0;
+    std::string m_profileDumpPath;
+    std::string m_recordingPath;
+
+    // Held by the simulation thread while it starts a round or runs ticks.
+    // Taken inside m_mutex, never the other way round.
+    std::mutex m_worldMutex;
+
+    std::thread m_thread;
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,243 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "AabbBatch.h"
+
+void SpatialGrid::build(const std::vector<sf::FloatRect>& rects, sf::Vector2u cellSize) {
+    if (rects.empty()) {
+        // Nothing to cover: no cells at all
+        build(rects, cellSize, sf::FloatRect(0, 0, -1, -1));
+        return;
+    }
+
+    float left = rects[0].left;
+    float top = rects[0].top;
+    float right = left + rects[0].width;
+    float bottom = top + rects[0].height;
+    for (const auto& rect : rects) {
+        left = std::min(left, rect.left);
+        top = std::min(top, rect.top);
+        right = std::max(right, rect.left + rect.width);
+        bottom = std::max(bottom, rect.top + rect.height);
+    }
+    build(rects, cellSize, sf::FloatRect(left, top, right - left, bottom - top));
+}
+
+void SpatialGrid::build(const std::vector<sf::FloatRect>& rects, sf::Vector2u cellSize, const sf::FloatRect& bounds) {
+    m_rects = rects;
+    m_cellSize = sf::Vector2f(static_cast<float>(cellSize.x), static_cast<float>(cellSize.y));
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_itemLeft.clear();
+    m_itemTop.clear();
+    m_itemRight.clear();
+    m_itemBottom.clear();
+    m_editedCell.clear();
+    m_editedCells.clear();
+    m_removed.assign(m_rects.size(), false);
+    m_free.clear();
+    m_cols = 0;
+    m_rows = 0;
+
+    if (bounds.width < 0 || bounds.height < 0 || cellSize.x == 0 || cellSize.y == 0) {
+        return;
+    }
+
+    float left = bounds.left;
+    float top = bounds.top;
+    float right = bounds.left + bounds.width;
+    float bottom = bounds.top + bounds.height;
+
+    m_origin = sf::Vector2f(left, top);
+    m_cols = std::max(1, static_cast<int>(std::ceil((right - left) / m_cellSize.x)));
+    m_rows = std::max(1, static_cast<int>(std::ceil((bottom - top) / m_cellSize.y)));
+
+    // Counting pass, then a prefix sum turns the counts into bucket offsets.
+    m_cellStart.assign(static_cast<std::size_t>(m_cols) * m_rows + 1, 0);
+    int minX, minY, maxX, maxY;
+    for (const auto& rect : m_rects) {
+        if (cellRange(rect, minX, minY, maxX, maxY)) {
+            for (int cy = minY; cy <= maxY; ++cy) {
+                for (int cx = minX; cx <= maxX; ++cx) {
+                    m_cellStart[cy * m_cols + cx + 1]++;
+                }
+            }
+        }
+    }
+    for (std::size_t i = 1; i < m_cellStart.size(); ++i) {
+        m_cellStart[i] += m_cellStart[i - 1];
+    }
+
+    m_cellItems.resize(m_cellStart.back());
+    std::vector<std::size_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t i = 0; i < m_rects.size(); ++i) {
+        if (cellRange(m_rects[i], minX, minY, maxX, maxY)) {
+            for (int cy = minY; cy <= maxY; ++cy) {
+                for (int cx = minX; cx <= maxX; ++cx) {
+                    m_cellItems[fill[cy * m_cols + cx]++] = i;
+                }
+            }
+        }
+    }
+
+    m_itemLeft.resize(m_cellItems.size());
+    m_itemTop.resize(m_cellItems.size());
+    m_itemRight.resize(m_cellItems.size());
+    m_itemBottom.resize(m_cellItems.size());
+    for (std::size_t k = 0; k < m_cellItems.size(); ++k) {
+        const sf::FloatRect& rect = m_rects[m_cellItems[k]];
+        m_itemLeft[k] = rect.left;
+        m_itemTop[k] = rect.top;
+        m_itemRight[k] = rect.left + rect.width;
+        m_itemBottom[k] = rect.top + rect.height;
+    }
+}
+
+void SpatialGrid::query(const sf::FloatRect& area, std::vector<std::size_t>& indices) const {
+    int minX, minY, maxX, maxY;
+    if (!cellRange(area, minX, minY, maxX, maxY)) {
+        return;
+    }
+
+    std::size_t first = indices.size();
+    for (int cy = minY; cy <= maxY; ++cy) {
+        std::size_t row = static_cast<std::size_t>(cy) * m_cols;
+        if (m_editedCell.empty()) {
+            // Cells of one row are adjacent in m_cellItems, so the whole row
+            // span is a single batch test.
+            querySpan(area, m_cellStart[row + minX], m_cellStart[row + maxX + 1], indices);
+            continue;
+        }
+
+        // Edited cells are tested on their own; the runs of untouched cells
+        // between them are still one batch each.
+        int cx = minX;
+        while (cx <= maxX) {
+            std::uint32_t edited = m_editedCell[row + cx];
+            if (edited != 0) {
+                float right = area.left + area.width;
+                float bottom = area.top + area.height;
+                for (std::size_t index : m_editedCells[edited - 1]) {
+                    const sf::FloatRect& rect = m_rects[index];
+                    if (rect.left < right && area.left < rect.left + rect.width &&
+                        rect.top < bottom && area.top < rect.top + rect.height) {
+                        indices.push_back(index);
+                    }
+                }
+                cx++;
+                continue;
+            }
+
+            int runEnd = cx + 1;
+            while (runEnd <= maxX && m_editedCell[row + runEnd] == 0) {
+                runEnd++;
+            }
+            querySpan(area, m_cellStart[row + cx], m_cellStart[row + runEnd], indices);
+            cx = runEnd;
+        }
+    }
+
+    // A rect spanning several cells is found once per cell, and callers rely
+    // on getting rects back in ascending index order. Indices of removed
+    // rects are reused, so that is not the order the rects were added in.
+    std::sort(indices.begin() + first, indices.end());
+    indices.erase(std::unique(indices.begin() + first, indices.end()), indices.end());
+}
+
+void SpatialGrid::querySpan(const sf::FloatRect& area, std::size_t begin, std::size_t end,
+                            std::vector<std::size_t>& indices) const {
+    if (begin == end) {
+        return;
+    }
+
+    // Reused between queries so the batch output does not allocate. No span
+    // is longer than m_cellItems, so growing to that once per thread keeps
+    // a larger query area later on from allocating mid-game.
+    thread_local std::vector<std::uint32_t> hits;
+    if (hits.size() < end - begin) {
+        hits.resize(m_cellItems.size());
+    }
+
+    AabbArrays boxes = { &m_itemLeft[begin], &m_itemTop[begin], &m_itemRight[begin], &m_itemBottom[begin], end - begin };
+    std::size_t hitCount = intersectAabbs(area, boxes, hits.data());
+    for (std::size_t h = 0; h < hitCount; ++h) {
+        indices.push_back(m_cellItems[begin + hits[h]]);
+    }
+}
+
+std::size_t SpatialGrid::insert(const sf::FloatRect& rect) {
+    std::size_t index;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+        m_rects[index] = rect;
+        m_removed[index] = false;
+    } else {
+        index = m_rects.size();
+        m_rects.push_back(rect);
+        m_removed.push_back(false);
+    }
+
+    int minX, minY, maxX, maxY;
+    if (cellRange(rect, minX, minY, maxX, maxY)) {
+        for (int cy = minY; cy <= maxY; ++cy) {
+            for (int cx = minX; cx <= maxX; ++cx) {
+                editableCell(static_cast<std::size_t>(cy) * m_cols + cx).push_back(index);
+            }
+        }
+    }
+    return index;
+}
+
+void SpatialGrid::remove(std::size_t index) {
+    if (index >= m_rects.size() || m_removed[index]) {
+        return;
+    }
+    m_removed[index] = true;
+    m_free.push_back(index);
+
+    int minX, minY, maxX, maxY;
+    if (cellRange(m_rects[index], minX, minY, maxX, maxY)) {
+        for (int cy = minY; cy <= maxY; ++cy) {
+            for (int cx = minX; cx <= maxX; ++cx) {
+                std::vector<std::size_t>& bucket = editableCell(static_cast<std::size_t>(cy) * m_cols + cx);
+                bucket.erase(std::remove(bucket.begin(), bucket.end(), index), bucket.end());
+            }
+        }
+    }
+}
+
+std::vector<std::size_t>& SpatialGrid::editableCell(std::size_t cell) {
+    if (m_editedCell.empty()) {
+        m_editedCell.assign(m_cellStart.size() - 1, 0);
+    }
+    if (m_editedCell[cell] == 0) {
+        m_editedCells.emplace_back(m_cellItems.begin() + m_cellStart[cell], m_cellItems.begin() + m_cellStart[cell + 1]);
+        m_editedCell[cell] = static_cast<std::uint32_t>(m_editedCells.size());
+    }
+    return m_editedCells[m_editedCell[cell] - 1];
+}
+
+bool SpatialGrid::cellRange(const sf::FloatRect& area, int& minX, int& minY, int& maxX, int& maxY) const {
+    if (m_cols == 0 || m_rows == 0) {
+        return false;
+    }
+
+    float left = (area.left - m_origin.x) / m_cellSize.x;
+    float top = (area.top - m_origin.y) / m_cellSize.y;
+    float right = (area.left + area.width - m_origin.x) / m_cellSize.x;
+    float bottom = (area.top + area.height - m_origin.y) / m_cellSize.y;
+
+    if (right < 0 || bottom < 0 || left >= m_cols || top >= m_rows) {
+        return false;
+    }
+
+    minX = std::max(0, static_cast<int>(std::floor(left)));
+    minY = std::max(0, static_cast<int>(std::floor(top)));
+    maxX = std::min(m_cols - 1, static_cast<int>(std::floor(right)));
+    maxY = std::min(m_rows - 1, static_cast<int>(std::floor(bottom)));
+    return true;
+}
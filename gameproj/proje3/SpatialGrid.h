@@ -0,0 +1,71 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over a set of rects. Each rect is bucketed into every cell
+// it overlaps and the buckets are stored back to back in one index array,
+// so a query only touches the cells under the search area. Bucket entries
+// also carry a copy of their rect's edges, which lets a query test a whole
+// row of cells with one batch intersection call.
+//
+// Rects can be inserted and removed after build(). A cell touched by such
+// an edit moves its bucket out of the packed array into a list of its own,
+// so an edit costs the same however large the grid is.
+class SpatialGrid {
+public:
+    void build(const std::vector<sf::FloatRect>& rects, sf::Vector2u cellSize);
+
+    // Same, but the grid covers bounds rather than just the rects, so rects
+    // inserted later anywhere inside bounds can be found.
+    void build(const std::vector<sf::FloatRect>& rects, sf::Vector2u cellSize, const sf::FloatRect& bounds);
+
+    // Appends the indices of all rects intersecting area, in ascending order.
+    void query(const sf::FloatRect& area, std::vector<std::size_t>& indices) const;
+
+    // Adds rect and returns its index. The slot of the last removed rect is
+    // reused if there is one, so edits do not grow getRects(). A rect
+    // outside the grid is kept but never found.
+    std::size_t insert(const sf::FloatRect& rect);
+
+    // Stops returning the rect at index. The other indices do not change.
+    void remove(std::size_t index);
+
+    // Every rect built or inserted, by index. Removed ones stay until their
+    // slot is reused.
+    const std::vector<sf::FloatRect>& getRects() const {
+        return m_rects;
+    }
+
+private:
+    bool cellRange(const sf::FloatRect& area, int& minX, int& minY, int& maxX, int& maxY) const;
+    void querySpan(const sf::FloatRect& area, std::size_t begin, std::size_t end, std::vector<std::size_t>& indices) const;
+    std::vector<std::size_t>& editableCell(std::size_t cell);
+
+    std::vector<sf::FloatRect> m_rects;
+    std::vector<std::size_t> m_cellStart; // m_cols * m_rows + 1 offsets into m_cellItems
+    std::vector<std::size_t> m_cellItems;
+    std::vector<float> m_itemLeft; // edges of m_cellItems[k], parallel to it
+    std::vector<float> m_itemTop;
+    std::vector<float> m_itemRight;
+    std::vector<float> m_itemBottom;
+    sf::Vector2f m_origin;
+    sf::Vector2f m_cellSize;
+    int m_cols = 0;
+    int m_rows = 0;
+
+    // Cells edited since build(): 1 + the index of their bucket in
+    // m_editedCells, 0 for cells still in m_cellItems. Empty until the
+    // first edit.
+    std::vector<std::uint32_t> m_editedCell;
+    std::vector<std::vector<std::size_t>> m_editedCells;
+
+    // Slots of removed rects, reused last freed first
+    std::vector<bool> m_removed;
+    std::vector<std::size_t> m_free;
+};
+
+#endif // SPATIALGRID_H
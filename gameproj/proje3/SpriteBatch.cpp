@@ -0,0 +1,193 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+
+namespace {
+
+sf::Uint32 codePoint(sf::Uint32 c) {
+    return c;
+}
+
+sf::Uint32 codePoint(char c) {
+    return static_cast<unsigned char>(c); // Latin-1
+}
+
+// Shared by both layoutText overloads; String is sf::String or std::string.
+template <typename String>
+sf::Vector2f layoutGlyphs(const sf::Font& font, const String& string, std::size_t length, unsigned int characterSize,
+                          const sf::Vector2f& position, sf::Color color, std::vector<sf::Vertex>& vertices) {
+    // Same layout as sf::Text: the first baseline sits characterSize below
+    // the top, and glyph quads are padded by a pixel so their smoothed
+    // edges are not cut off.
+    const float padding = 1.0f;
+    float whitespaceWidth = font.getGlyph(L' ', characterSize, false).advance;
+    float lineSpacing = font.getLineSpacing(characterSize);
+    float x = 0;
+    float y = static_cast<float>(characterSize);
+
+    sf::Uint32 previous = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        sf::Uint32 current = codePoint(string[i]);
+        x += font.getKerning(previous, current, characterSize);
+        previous = current;
+
+        if (current == L' ') {
+            x += whitespaceWidth;
+            continue;
+        } else if (current == L'\t') {
+            x += whitespaceWidth * 4;
+            continue;
+        } else if (current == L'\n') {
+            y += lineSpacing;
+            x = 0;
+            continue;
+        }
+
+        const sf::Glyph& glyph = font.getGlyph(current, characterSize, false);
+        float left = position.x + x + glyph.bounds.left - padding;
+        float top = position.y + y + glyph.bounds.top - padding;
+        float right = position.x + x + glyph.bounds.left + glyph.bounds.width + padding;
+        float bottom = position.y + y + glyph.bounds.top + glyph.bounds.height + padding;
+
+        float u1 = static_cast<float>(glyph.textureRect.left) - padding;
+        float v1 = static_cast<float>(glyph.textureRect.top) - padding;
+        float u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+        float v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+        vertices.push_back(sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u1, v1)));
+        vertices.push_back(sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1)));
+        vertices.push_back(sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u2, v2)));
+        vertices.push_back(sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2)));
+
+        x += glyph.advance;
+    }
+    return sf::Vector2f(x, y);
+}
+
+}
+
+SpriteBatch::Stream& SpriteBatch::stream(const sf::Texture* texture, int layer) {
+    if (m_lastStream < m_streamCount) {
+        Stream& last = m_streams[m_lastStream];
+        if (last.texture == texture && last.layer == layer) {
+            return last;
+        }
+    }
+
+    for (std::size_t i = 0; i < m_streamCount; ++i) {
+        if (m_streams[i].texture == texture && m_streams[i].layer == layer) {
+            m_lastStream = i;
+            return m_streams[i];
+        }
+    }
+
+    if (m_streamCount == m_streams.size()) {
+        m_streams.emplace_back();
+    }
+    m_lastStream = m_streamCount;
+    Stream& added = m_streams[m_streamCount];
+    added.layer = layer;
+    added.texture = texture;
+    added.firstUse = m_streamCount;
+    m_streamCount++;
+    return added;
+}
+
+sf::Vertex* SpriteBatch::append(const sf::Texture* texture, int layer, std::size_t count) {
+    std::vector<sf::Vertex>& vertices = stream(texture, layer).vertices;
+    std::size_t first = vertices.size();
+    vertices.resize(first + count);
+    return &vertices[first];
+}
+
+void SpriteBatch::addQuad(const sf::Texture* texture, int layer, const sf::FloatRect& rect, const sf::IntRect& source,
+                          sf::Color color, bool flipX) {
+    float left = static_cast<float>(source.left);
+    float right = static_cast<float>(source.left + source.width);
+    float top = static_cast<float>(source.top);
+    float bottom = static_cast<float>(source.top + source.height);
+    if (flipX) {
+        std::swap(left, right);
+    }
+
+    sf::Vertex* quad = append(texture, layer, 4);
+    quad[0] = sf::Vertex(sf::Vector2f(rect.left, rect.top), color, sf::Vector2f(left, top));
+    quad[1] = sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), color, sf::Vector2f(right, top));
+    quad[2] = sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), color, sf::Vector2f(right, bottom));
+    quad[3] = sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), color, sf::Vector2f(left, bottom));
+}
+
+void SpriteBatch::addRect(int layer, const sf::FloatRect& rect, sf::Color color) {
+    addQuad(nullptr, layer, rect, sf::IntRect(), color);
+}
+
+void SpriteBatch::addQuads(const sf::Texture* texture, int layer, const sf::Vertex* vertices, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    std::copy(vertices, vertices + count, append(texture, layer, count));
+}
+
+void SpriteBatch::addText(const sf::Font& font, const sf::String& string, unsigned int characterSize,
+                          const sf::Vector2f& position, sf::Color color, int layer) {
+    // Font pages live in a map and grow in place, so the texture pointer
+    // stays valid while the layout adds glyphs to it.
+    layoutText(font, string, characterSize, position, color, stream(&font.getTexture(characterSize), layer).vertices);
+}
+
+sf::Vector2f layoutText(const sf::Font& font, const sf::String& string, unsigned int characterSize,
+                        const sf::Vector2f& position, sf::Color color, std::vector<sf::Vertex>& vertices) {
+    return layoutGlyphs(font, string, string.getSize(), characterSize, position, color, vertices);
+}
+
+sf::Vector2f layoutText(const sf::Font& font, const std::string& string, unsigned int characterSize,
+                        const sf::Vector2f& position, sf::Color color, std::vector<sf::Vertex>& vertices) {
+    return layoutGlyphs(font, string, string.size(), characterSize, position, color, vertices);
+}
+
+void SpriteBatch::setLayerShader(int layer, const sf::Shader* shader) {
+    for (auto& layerShader : m_layerShaders) {
+        if (layerShader.first == layer) {
+            layerShader.second = shader;
+            return;
+        }
+    }
+    m_layerShaders.push_back(std::make_pair(layer, shader));
+}
+
+unsigned SpriteBatch::flush(sf::RenderTarget& target, sf::RenderStates states) {
+    const sf::Shader* defaultShader = states.shader;
+    m_order.clear();
+    for (std::size_t i = 0; i < m_streamCount; ++i) {
+        if (!m_streams[i].vertices.empty()) {
+            m_order.push_back(&m_streams[i]);
+        }
+    }
+    std::sort(m_order.begin(), m_order.end(), [](const Stream* a, const Stream* b) {
+        return a->layer != b->layer ? a->layer < b->layer : a->firstUse < b->firstUse;
+    });
+
+    unsigned drawCalls = 0;
+    unsigned vertexCount = 0;
+    for (Stream* stream : m_order) {
+        states.texture = stream->texture;
+        states.shader = defaultShader;
+        for (const auto& layerShader : m_layerShaders) {
+            if (layerShader.first == stream->layer && layerShader.second) {
+                states.shader = layerShader.second;
+            }
+        }
+        target.draw(stream->vertices.data(), stream->vertices.size(), sf::Quads, states);
+        drawCalls++;
+        vertexCount += static_cast<unsigned>(stream->vertices.size());
+        stream->vertices.clear();
+    }
+    m_streamCount = 0;
+    m_lastStream = 0;
+
+    if (m_profiler) {
+        m_profiler->addDrawCalls(drawCalls);
+        m_profiler->addVertices(vertexCount);
+    }
+    return drawCalls;
+}
@@ -0,0 +1,86 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrameProfiler.h"
+
+// Collects quads for a frame and draws them with as few calls as possible.
+// Quads go into one vertex stream per (layer, texture); flush() draws the
+// streams lowest layer first, one call each. Within a stream quads keep the
+// order they were added in, but streams of one layer are drawn in the order
+// they were first used, so things that must overlap a certain way belong
+// in different layers.
+//
+// Streams are reused from frame to frame, so once they have grown to a
+// frame's worth of quads nothing allocates.
+class SpriteBatch {
+public:
+    // Counts every flush's draw calls and vertices in profiler. Null (the
+    // default) turns that off.
+    void setProfiler(FrameProfiler* profiler) {
+        m_profiler = profiler;
+    }
+
+    // Room for count vertices (quads of four) at the end of the stream for
+    // texture in layer. Filling them in place saves building them twice;
+    // the pointer is valid until the next call. texture may be null for
+    // plain coloured quads.
+    sf::Vertex* append(const sf::Texture* texture, int layer, std::size_t count);
+
+    // Queues one quad covering rect, showing the source pixels of texture.
+    // flipX mirrors the image horizontally.
+    void addQuad(const sf::Texture* texture, int layer, const sf::FloatRect& rect, const sf::IntRect& source,
+                 sf::Color color = sf::Color::White, bool flipX = false);
+
+    // Queues an untextured quad.
+    void addRect(int layer, const sf::FloatRect& rect, sf::Color color);
+
+    // Queues ready-made quads.
+    void addQuads(const sf::Texture* texture, int layer, const sf::Vertex* vertices, std::size_t count);
+
+    // Queues one glyph quad per character, laid out like sf::Text with the
+    // top left at position. Regular style, no outline.
+    void addText(const sf::Font& font, const sf::String& string, unsigned int characterSize,
+                 const sf::Vector2f& position, sf::Color color, int layer);
+
+    // Draws the streams of layer with shader instead of the one passed to
+    // flush(), e.g. TileMap's animation shader. Null clears it.
+    void setLayerShader(int layer, const sf::Shader* shader);
+
+    // Draws and empties every stream. Returns the number of draw calls.
+    unsigned flush(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default);
+
+private:
+    struct Stream {
+        int layer = 0;
+        const sf::Texture* texture = nullptr;
+        std::size_t firstUse = 0; // order among this frame's streams
+        std::vector<sf::Vertex> vertices;
+    };
+
+    Stream& stream(const sf::Texture* texture, int layer);
+
+    std::vector<Stream> m_streams; // [0, m_streamCount) hold this frame's quads
+    std::size_t m_streamCount = 0;
+    std::size_t m_lastStream = 0; // consecutive quads usually share a stream
+    std::vector<Stream*> m_order;
+    std::vector<std::pair<int, const sf::Shader*>> m_layerShaders;
+    FrameProfiler* m_profiler = nullptr;
+};
+
+// Appends one glyph quad per character of string to vertices, laid out
+// like sf::Text (regular style, no outline) with the top left at position.
+// Returns the pen position after the last character: its x and the
+// baseline of its line, relative to position. The std::string overload
+// reads it as Latin-1 and needs no sf::String copy.
+sf::Vector2f layoutText(const sf::Font& font, const sf::String& string, unsigned int characterSize,
+                        const sf::Vector2f& position, sf::Color color, std::vector<sf::Vertex>& vertices);
+sf::Vector2f layoutText(const sf::Font& font, const std::string& string, unsigned int characterSize,
+                        const sf::Vector2f& position, sf::Color color, std::vector<sf::Vertex>& vertices);
+
+#endif // SPRITEBATCH_H
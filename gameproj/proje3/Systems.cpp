@@ -0,0 +1,193 @@
+#include "Systems.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+void moveRange(GameEntities& entities, std::size_t begin, std::size_t end, float deltaTime) {
+    const ComponentPool<Velocity>& velocities = entities.pool<Velocity>();
+    ComponentPool<Transform>& transforms = entities.pool<Transform>();
+    const ComponentPool<Collider>& colliders = entities.pool<Collider>();
+    const Velocity* velocity = velocities.data();
+    const Entity* owner = velocities.entities();
+    Transform* transform = transforms.data();
+
+    for (std::size_t i = begin; i < end; ++i) {
+        Entity entity = owner[i];
+        std::size_t collider = colliders.find(entity, i);
+        if (collider < colliders.size() && colliders.data()[collider].sweepTiles) {
+            continue;
+        }
+        Transform& moved = transform[transforms.find(entity, i)];
+        moved.previous = moved.position;
+        moved.position.x += velocity[i].value.x * deltaTime;
+        moved.position.y += velocity[i].value.y * deltaTime;
+    }
+}
+
+// Pushes a body out of a tile it overlaps along the side with the
+// smallest overlap.
+void pushOut(Transform& transform, Velocity& velocity, Collider& collider, Control* control, const sf::FloatRect& tile) {
+    sf::FloatRect bounds(transform.position, collider.size);
+    if (!bounds.intersects(tile)) {
+        return;
+    }
+
+    float overlapBottom = bounds.top + bounds.height - tile.top;
+    float overlapTop = tile.top + tile.height - bounds.top;
+    float overlapRight = bounds.left + bounds.width - tile.left;
+    float overlapLeft = tile.left + tile.width - bounds.left;
+
+    bool fromBottom = overlapBottom < overlapTop && overlapBottom < overlapRight && overlapBottom < overlapLeft;
+    bool fromTop = overlapTop < overlapBottom && overlapTop < overlapRight && overlapTop < overlapLeft;
+    bool fromRight = overlapRight < overlapLeft && overlapRight < overlapTop && overlapRight < overlapBottom;
+    bool fromLeft = overlapLeft < overlapRight && overlapLeft < overlapTop && overlapLeft < overlapBottom;
+
+    if (fromBottom) {
+        transform.position.y = tile.top - bounds.height;
+        velocity.value.y = 0;
+        collider.onGround = true;
+        if (control) {
+            control->jumpCount = 0;
+        }
+    } else if (fromTop) {
+        transform.position.y = tile.top + tile.height;
+        velocity.value.y = 0;
+    } else if (fromRight) {
+        transform.position.x = tile.left - bounds.width;
+    } else if (fromLeft) {
+        transform.position.x = tile.left + tile.width;
+    }
+}
+
+void sweepBody(Transform& transform, Velocity& velocity, Collider& collider, Control* control,
+               const TileCollision& collision, float deltaTime, FrameArena& arena) {
+    transform.previous = transform.position;
+    sf::Vector2f motion(velocity.value.x * deltaTime, velocity.value.y * deltaTime);
+    sf::FloatRect bounds(transform.position, collider.size);
+
+    // Only tiles under the area swept this tick can be hit
+    float sweptLeft = std::min(bounds.left, bounds.left + motion.x);
+    float sweptTop = std::min(bounds.top, bounds.top + motion.y);
+    sf::FloatRect sweptBounds(sweptLeft, sweptTop, bounds.width + std::abs(motion.x), bounds.height + std::abs(motion.y));
+    FrameVector<sf::FloatRect> tiles = collision.queryCollisionRects(sweptBounds, arena);
+
+    // Horizontal: only tiles overlapping the body's rows can block, and of
+    // those the nearest one ahead gives the time of impact.
+    float moveX = motion.x;
+    if (moveX != 0) {
+        for (const auto& tile : tiles) {
+            if (bounds.top < tile.top + tile.height && tile.top < bounds.top + bounds.height) {
+                if (moveX > 0 && bounds.left + bounds.width <= tile.left) {
+                    moveX = std::min(moveX, tile.left - (bounds.left + bounds.width));
+                } else if (moveX < 0 && bounds.left >= tile.left + tile.width) {
+                    moveX = std::max(moveX, tile.left + tile.width - bounds.left);
+                }
+            }
+        }
+        bounds.left += moveX;
+    }
+
+    // Vertical, with the body already at its new column.
+    float moveY = motion.y;
+    collider.onGround = false;
+    if (moveY != 0) {
+        for (const auto& tile : tiles) {
+            if (bounds.left < tile.left + tile.width && tile.left < bounds.left + bounds.width) {
+                if (moveY > 0 && bounds.top + bounds.height <= tile.top) {
+                    moveY = std::min(moveY, tile.top - (bounds.top + bounds.height));
+                } else if (moveY < 0 && bounds.top >= tile.top + tile.height) {
+                    moveY = std::max(moveY, tile.top + tile.height - bounds.top);
+                }
+            }
+        }
+
+        if (moveY < motion.y && motion.y > 0) {
+            velocity.value.y = 0;
+            collider.onGround = true;
+            if (control) {
+                control->jumpCount = 0;
+            }
+        } else if (moveY > motion.y && motion.y < 0) {
+            velocity.value.y = 0;
+        }
+    }
+
+    transform.position.x += moveX;
+    transform.position.y += moveY;
+
+    // Tiles the body already overlapped before moving (e.g. at the spawn
+    // point) cannot be swept against; push out of those the old way. This
+    // is the one step that depends on the order tiles come back in, grid
+    // index order, which is the same every run for the same edits.
+    for (const auto& tile : tiles) {
+        pushOut(transform, velocity, collider, control, tile);
+    }
+}
+
+}
+
+sf::FloatRect colliderBounds(const GameEntities& entities, Entity entity) {
+    return sf::FloatRect(entities.get<Transform>(entity).position, entities.get<Collider>(entity).size);
+}
+
+void applyGravity(GameEntities& entities, float deltaTime) {
+    ComponentPool<Velocity>& velocities = entities.pool<Velocity>();
+    Velocity* velocity = velocities.data();
+    for (std::size_t i = 0, count = velocities.size(); i < count; ++i) {
+        velocity[i].value.y += velocity[i].gravity * deltaTime;
+    }
+}
+
+void animate(GameEntities& entities, float deltaTime) {
+    ComponentPool<Animation>& animations = entities.pool<Animation>();
+    const ComponentPool<Collider>& colliders = entities.pool<Collider>();
+    Animation* animation = animations.data();
+    const Entity* owner = animations.entities();
+
+    for (std::size_t i = 0, count = animations.size(); i < count; ++i) {
+        // Driven by simulated time rather than a wall clock so headless runs
+        // produce the same frames as the game.
+        Animation& a = animation[i];
+        a.timer += deltaTime;
+        if (a.timer < a.frameTime) {
+            continue;
+        }
+
+        std::size_t collider = colliders.find(owner[i], i);
+        bool onGround = collider < colliders.size() && colliders.data()[collider].onGround;
+        int row = onGround ? a.groundRow : a.airRow;
+        a.frameIndex = (a.frameIndex + 1) % (onGround ? a.groundFrames : a.airFrames);
+        a.frame = sf::IntRect(a.frameIndex * a.frameSize.x, row * a.frameSize.y, a.frameSize.x, a.frameSize.y);
+        a.timer = 0.0f;
+    }
+}
+
+void moveBodies(GameEntities& entities, float deltaTime, JobSystem* jobs) {
+    std::size_t count = entities.pool<Velocity>().size();
+    if (jobs && jobs->getThreadCount() > 1 && count >= PARALLEL_BODIES) {
+        // Each body only writes its own Transform, so pieces never overlap.
+        jobs->parallelFor(count, PARALLEL_BODY_GRAIN, [&](std::size_t begin, std::size_t end, unsigned) {
+            moveRange(entities, begin, end, deltaTime);
+        });
+        return;
+    }
+    moveRange(entities, 0, count, deltaTime);
+}
+
+void sweepTiles(GameEntities& entities, const TileCollision& collision, float deltaTime, FrameArena& arena) {
+    ComponentPool<Collider>& colliders = entities.pool<Collider>();
+    ComponentPool<Control>& controls = entities.pool<Control>();
+    Collider* collider = colliders.data();
+    const Entity* owner = colliders.entities();
+
+    for (std::size_t i = 0, count = colliders.size(); i < count; ++i) {
+        if (!collider[i].sweepTiles) {
+            continue;
+        }
+        Entity entity = owner[i];
+        Control* control = controls.has(entity) ? &controls.get(entity) : nullptr;
+        sweepBody(entities.get<Transform>(entity), entities.get<Velocity>(entity), collider[i], control, collision, deltaTime, arena);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include <SFML/Graphics.hpp>
+
+#include "Components.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "TileCollision.h"
+
+// Systems walk one packed component pool from front to back and look the
+// entity's other components up by id.
+
+// Below this many bodies moveBodies does not wake the job threads.
+const std::size_t PARALLEL_BODIES = 8192;
+const std::size_t PARALLEL_BODY_GRAIN = 2048;
+
+// Box of an entity with a Transform and a Collider.
+sf::FloatRect colliderBounds(const GameEntities& entities, Entity entity);
+
+// Adds each Velocity's gravity to its vertical speed.
+void applyGravity(GameEntities& entities, float deltaTime);
+
+// Advances every Animation, on its ground row when the entity's Collider
+// stands on something and on its air row otherwise.
+void animate(GameEntities& entities, float deltaTime);
+
+// Moves every body that has a Velocity and does not sweep tiles. With a job
+// system and enough bodies the pool is split across its threads.
+void moveBodies(GameEntities& entities, float deltaTime, JobSystem* jobs = nullptr);
+
+// Moves every Collider with sweepTiles by its Velocity, stopping at the first
+// tile hit along each axis: x first, then y. Landing or hitting a ceiling
+// zeroes the vertical speed; landing also sets onGround and resets the
+// jump count of a Control. Tiles already overlapped before the move (e.g. at
+// a spawn point) push the body out along the shallowest side instead. The
+// tile lists of the sweep are allocated from arena.
+void sweepTiles(GameEntities& entities, const TileCollision& collision, float deltaTime, FrameArena& arena);
+
+#endif // SYSTEMS_H
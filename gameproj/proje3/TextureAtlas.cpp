@@ -0,0 +1,95 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+const int PADDING = 1;
+
+}
+
+void TextureAtlas::add(const std::string& name, std::shared_ptr<const sf::Texture> texture) {
+    Entry entry;
+    entry.name = name;
+    entry.source = texture;
+    m_entries.push_back(entry);
+}
+
+bool TextureAtlas::pack(unsigned int size, std::vector<sf::IntRect>& rects) const {
+    rects.resize(m_entries.size());
+    int x = PADDING;
+    int y = PADDING;
+    int shelfHeight = 0;
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        sf::Vector2u imageSize = m_entries[i].source->getSize();
+        int width = static_cast<int>(imageSize.x);
+        int height = static_cast<int>(imageSize.y);
+
+        if (x + width + PADDING > static_cast<int>(size)) {
+            // Start a new shelf above the tallest image of this one
+            x = PADDING;
+            y += shelfHeight + PADDING;
+            shelfHeight = 0;
+        }
+        if (x + width + PADDING > static_cast<int>(size) || y + height + PADDING > static_cast<int>(size)) {
+            return false;
+        }
+
+        rects[i] = sf::IntRect(x, y, width, height);
+        x += width + PADDING;
+        shelfHeight = std::max(shelfHeight, height);
+    }
+    return true;
+}
+
+bool TextureAtlas::build() {
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+        return a.source->getSize().y > b.source->getSize().y;
+    });
+
+    // Packed aside and only stored once the texture exists, so that a failed
+    // rebuild leaves the current texture and its rects as they were
+    std::vector<sf::IntRect> rects;
+    unsigned int size = 64;
+    unsigned int maximumSize = sf::Texture::getMaximumSize();
+    while (!pack(size, rects)) {
+        if (size >= maximumSize) {
+            std::cerr << "Textures do not fit into one " << maximumSize << "x" << maximumSize << " atlas" << std::endl;
+            return false;
+        }
+        size *= 2;
+    }
+
+    sf::Image image;
+    image.create(size, size, sf::Color::Transparent);
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        image.copy(m_entries[i].source->copyToImage(), rects[i].left, rects[i].top);
+    }
+
+    std::shared_ptr<sf::Texture> texture = std::make_shared<sf::Texture>();
+    if (!texture->loadFromImage(image)) {
+        std::cerr << "Could not create atlas texture" << std::endl;
+        return false;
+    }
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        m_entries[i].rect = rects[i];
+    }
+    m_texture = texture;
+    return true;
+}
+
+TextureRegion TextureAtlas::getRegion(const std::string& name) const {
+    TextureRegion region;
+    if (!m_texture) {
+        return region;
+    }
+    for (const auto& entry : m_entries) {
+        if (entry.name == name) {
+            region.texture = m_texture.get();
+            region.rect = entry.rect;
+            break;
+        }
+    }
+    return region;
+}
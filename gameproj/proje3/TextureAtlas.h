@@ -0,0 +1,53 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A rectangle of a texture, e.g. one image packed into a TextureAtlas.
+struct TextureRegion {
+    const sf::Texture* texture = nullptr;
+    sf::IntRect rect;
+};
+
+// Packs several textures into one, so sprites using any of them can go
+// into the same SpriteBatch stream and be drawn with one call. Images are
+// placed on shelves, tallest first, with a pixel of transparent padding
+// around each so a neighbour never bleeds in.
+class TextureAtlas {
+public:
+    // texture is read back from the GPU by build(), so it must be loaded
+    // by then.
+    void add(const std::string& name, std::shared_ptr<const sf::Texture> texture);
+
+    // Packs everything added into the smallest square power-of-two texture
+    // it fits in, up to the GPU's maximum texture size. Can be called again
+    // after a source changed; that makes a new texture, and whoever holds
+    // the old one keeps showing the old images. On failure the texture and
+    // regions from the last successful build stay as they were.
+    bool build();
+
+    std::shared_ptr<const sf::Texture> getTexture() const {
+        return m_texture;
+    }
+
+    // Where name was packed; an empty region before build() or if it was
+    // never added.
+    TextureRegion getRegion(const std::string& name) const;
+
+private:
+    struct Entry {
+        std::string name;
+        std::shared_ptr<const sf::Texture> source;
+        sf::IntRect rect;
+    };
+
+    bool pack(unsigned int size, std::vector<sf::IntRect>& rects) const;
+
+    std::vector<Entry> m_entries;
+    std::shared_ptr<sf::Texture> m_texture;
+};
+
+#endif // TEXTUREATLAS_H
@@ -0,0 +1,106 @@
+#include "TileCollision.h"
+
+#include <algorithm>
+
+namespace {
+
+// Grid indices a query has room for before it allocates.
+const std::size_t QUERY_RESERVE = 1024;
+
+}
+
+void TileCollision::build(const LevelView& level, sf::Vector2u tileSize) {
+    std::vector<sf::FloatRect> collisionRects;
+    std::vector<sf::FloatRect> crownRects;
+    collisionRects.reserve(level.collisionCount);
+    crownRects.reserve(level.crownCount);
+
+    for (size_t i = 0; i < level.collisionCount; ++i) {
+        std::uint32_t index = level.collision[i];
+        collisionRects.push_back(sf::FloatRect(level.x[index], level.y[index], tileSize.x, tileSize.y));
+    }
+
+    for (size_t i = 0; i < level.crownCount; ++i) {
+        std::uint32_t index = level.crowns[i];
+        crownRects.push_back(sf::FloatRect(level.x[index], level.y[index], tileSize.x, tileSize.y));
+    }
+
+    // Both grids cover every tile of the level, so a tile edited into a
+    // platform or a crown later is found wherever it is.
+    sf::FloatRect bounds(0, 0, -1, -1);
+    if (level.tileCount > 0) {
+        float left = level.x[0];
+        float top = level.y[0];
+        float right = left;
+        float bottom = top;
+        for (size_t i = 1; i < level.tileCount; ++i) {
+            left = std::min(left, static_cast<float>(level.x[i]));
+            top = std::min(top, static_cast<float>(level.y[i]));
+            right = std::max(right, static_cast<float>(level.x[i]));
+            bottom = std::max(bottom, static_cast<float>(level.y[i]));
+        }
+        bounds = sf::FloatRect(left, top, right - left + tileSize.x, bottom - top + tileSize.y);
+    }
+
+    // Buckets are keyed on the tile size, so a player-sized query touches a
+    // handful of cells no matter how large the level is.
+    m_collisionGrid.build(collisionRects, tileSize, bounds);
+    m_crownGrid.build(crownRects, tileSize, bounds);
+}
+
+void TileCollision::addCollisionRect(const sf::FloatRect& rect) {
+    m_collisionGrid.insert(rect);
+}
+
+bool TileCollision::removeCollisionRect(const sf::FloatRect& rect) {
+    return remove(m_collisionGrid, rect);
+}
+
+void TileCollision::addCrownRect(const sf::FloatRect& rect) {
+    m_crownGrid.insert(rect);
+}
+
+bool TileCollision::removeCrownRect(const sf::FloatRect& rect) {
+    return remove(m_crownGrid, rect);
+}
+
+FrameVector<sf::FloatRect> TileCollision::queryCollisionRects(const sf::FloatRect& area, FrameArena& arena) const {
+    return query(m_collisionGrid, area, arena);
+}
+
+FrameVector<sf::FloatRect> TileCollision::queryCrownRects(const sf::FloatRect& area, FrameArena& arena) const {
+    return query(m_crownGrid, area, arena);
+}
+
+FrameVector<sf::FloatRect> TileCollision::query(const SpatialGrid& grid, const sf::FloatRect& area, FrameArena& arena) {
+    // Reused between queries, like the grid's own batch output. Reserved
+    // well past what a body's sweep area finds, so that it is not grown
+    // bit by bit in the middle of a round.
+    thread_local std::vector<std::size_t> indices;
+    if (indices.capacity() < QUERY_RESERVE) {
+        indices.reserve(QUERY_RESERVE);
+    }
+    indices.clear();
+    grid.query(area, indices);
+
+    FrameVector<sf::FloatRect> rects{FrameAllocator<sf::FloatRect>(arena)};
+    rects.reserve(indices.size());
+    for (std::size_t index : indices) {
+        rects.push_back(grid.getRects()[index]);
+    }
+    return rects;
+}
+
+bool TileCollision::remove(SpatialGrid& grid, const sf::FloatRect& rect) {
+    std::vector<std::size_t> indices;
+    grid.query(rect, indices);
+
+    // Equal rects are interchangeable; the one with the highest index goes
+    for (auto it = indices.rbegin(); it != indices.rend(); ++it) {
+        if (grid.getRects()[*it] == rect) {
+            grid.remove(*it);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#ifndef TILECOLLISION_H
+#define TILECOLLISION_H
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <vector>
+
+#include "FrameArena.h"
+#include "Level.h"
+#include "SpatialGrid.h"
+
+// Collision and crown rects of a level, bucketed for area queries. Needs no
+// textures, so the simulation can use it without a window.
+class TileCollision {
+public:
+    void build(const LevelView& level, sf::Vector2u tileSize);
+
+    // Runtime edits, e.g. from TileMap::setTile. Only rects inside the
+    // level's extent at build() time are found by queries. Removing takes
+    // out one rect equal to rect and returns false if there is none.
+    void addCollisionRect(const sf::FloatRect& rect);
+    bool removeCollisionRect(const sf::FloatRect& rect);
+    void addCrownRect(const sf::FloatRect& rect);
+    bool removeCrownRect(const sf::FloatRect& rect);
+
+    // Every rect loaded or added, by grid index. Removed ones stay until an
+    // added rect takes their slot.
+    const std::vector<sf::FloatRect>& getCollisionRects() const {
+        return m_collisionGrid.getRects();
+    }
+
+    const std::vector<sf::FloatRect>& getCrownRects() const {
+        return m_crownGrid.getRects();
+    }
+
+    // Only the rects overlapping area, in ascending grid index order (the
+    // order of getCollisionRects(), which edits do not keep in load order).
+    // The list is allocated from arena and is gone at its next reset().
+    FrameVector<sf::FloatRect> queryCollisionRects(const sf::FloatRect& area, FrameArena& arena) const;
+    FrameVector<sf::FloatRect> queryCrownRects(const sf::FloatRect& area, FrameArena& arena) const;
+
+private:
+    static FrameVector<sf::FloatRect> query(const SpatialGrid& grid, const sf::FloatRect& area, FrameArena& arena);
+    static bool remove(SpatialGrid& grid, const sf::FloatRect& rect);
+
+    SpatialGrid m_collisionGrid;
+    SpatialGrid m_crownGrid;
+};
+
+#endif // TILECOLLISION_H
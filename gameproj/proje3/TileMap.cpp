@@ -0,0 +1,472 @@
+#include "TileMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// An animated quad's colour holds its frame count in red and its frames per
+// second, in tenths, in green; blue is 0, which no still tile (white) has.
+// The frames follow each other frameWidth pixels apart.
+const char* ANIMATION_VERTEX_SHADER =
+    "uniform float time;\n"
+    "uniform float frameWidth;\n"
+    "void main() {\n"
+    "    vec4 texCoord = gl_MultiTexCoord0;\n"
+    "    vec4 color = gl_Color;\n"
+    "    if (color.b < 0.5) {\n"
+    "        float frames = floor(color.r * 255.0 + 0.5);\n"
+    "        float rate = color.g * 25.5;\n"
+    "        texCoord.x += mod(floor(time * rate), frames) * frameWidth;\n"
+    "        color = vec4(1.0);\n"
+    "    }\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;\n"
+    "    gl_TexCoord[0] = gl_TextureMatrix[0] * texCoord;\n"
+    "    gl_FrontColor = color;\n"
+    "}\n";
+
+const char* ANIMATION_FRAGMENT_SHADER =
+    "uniform sampler2D texture;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(texture, gl_TexCoord[0].xy) * gl_Color;\n"
+    "}\n";
+
+// Created by the first upload() and never destroyed, so that it does not
+// outlive the GL context at exit.
+sf::Shader* animationShader = nullptr;
+bool animationShaderTried = false;
+
+}
+
+bool TileMap::load(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const LevelView& level,
+                   const sf::IntRect& region) {
+    if (!prepare(tileset, tileSize, level, region)) {
+        return false;
+    }
+    upload();
+    return true;
+}
+
+bool TileMap::prepare(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const LevelView& level,
+                      const sf::IntRect& region) {
+    if (!tileset)
+        return false;
+    m_animateTiles = true;
+    m_tilesetRegion = region;
+    if (region.width == 0 || region.height == 0) {
+        m_tilesetRegion = sf::IntRect(0, 0, tileset->getSize().x, tileset->getSize().y);
+    }
+    if (m_tilesetRegion.width < static_cast<int>(tileSize.x))
+        return false;
+    m_tileset = tileset;
+    m_tileSize = tileSize;
+
+    buildChunks(level);
+
+    m_collision.build(level, tileSize);
+
+    return true;
+}
+
+void TileMap::upload() {
+    if (!animationShaderTried) {
+        animationShaderTried = true;
+        if (sf::Shader::isAvailable()) {
+            animationShader = new sf::Shader();
+            if (animationShader->loadFromMemory(ANIMATION_VERTEX_SHADER, ANIMATION_FRAGMENT_SHADER)) {
+                animationShader->setUniform("texture", sf::Shader::CurrentTexture);
+                animationShader->setUniform("time", 0.0f);
+            } else {
+                delete animationShader;
+                animationShader = nullptr;
+            }
+        }
+    }
+    m_animateTiles = animationShader != nullptr;
+    if (m_animateTiles) {
+        animationShader->setUniform("frameWidth", static_cast<float>(m_tileSize.x));
+    }
+
+    m_useVertexBuffers = sf::VertexBuffer::isAvailable();
+    for (auto& chunk : m_chunks) {
+        if (!m_animateTiles) {
+            // Drawn without the shader the markers would tint the tiles
+            for (std::size_t v = 0; v < chunk.vertices.size(); v += 4) {
+                setQuad(&chunk.vertices[v], sf::Vector2i(chunk.vertices[v].position), chunk.tiles[v / 4]);
+            }
+        }
+        if (m_useVertexBuffers && !chunk.vertices.empty()) {
+            if (!chunk.buffer.create(chunk.vertices.size()) || !chunk.buffer.update(chunk.vertices.data())) {
+                m_useVertexBuffers = false;
+            }
+        }
+    }
+}
+
+void TileMap::buildChunks(const LevelView& level) {
+    m_chunks.clear();
+    m_chunkCols = 0;
+    m_chunkRows = 0;
+    m_levelArea = sf::IntRect();
+    m_useVertexBuffers = false;
+
+    if (level.tileCount == 0) {
+        return;
+    }
+
+    int minX = level.x[0];
+    int minY = level.y[0];
+    int maxX = level.x[0];
+    int maxY = level.y[0];
+    for (size_t i = 1; i < level.tileCount; ++i) {
+        minX = std::min(minX, level.x[i]);
+        minY = std::min(minY, level.y[i]);
+        maxX = std::max(maxX, level.x[i]);
+        maxY = std::max(maxY, level.y[i]);
+    }
+
+    m_levelArea = sf::IntRect(minX, minY, maxX - minX, maxY - minY);
+    m_chunkOrigin = sf::Vector2f(minX, minY);
+    m_chunkSize = sf::Vector2f(m_tileSize.x * CHUNK_TILES, m_tileSize.y * CHUNK_TILES);
+    m_chunkCols = static_cast<int>((maxX - minX) / m_chunkSize.x) + 1;
+    m_chunkRows = static_cast<int>((maxY - minY) / m_chunkSize.y) + 1;
+    m_chunks.resize(static_cast<std::size_t>(m_chunkCols) * m_chunkRows);
+
+    // Tiles are bucketed by chunk first, with counts per chunk and layer,
+    // so that each chunk is then sized once and filled while it is in
+    // cache: every quad is written straight to its place, decorations from
+    // the start of the chunk and platforms (see TileType::layer) after them.
+    std::vector<std::uint32_t> tileChunk(level.tileCount);
+    std::vector<std::uint32_t> chunkStart(m_chunks.size() + 1, 0);
+    std::vector<std::uint32_t> platformCount(m_chunks.size(), 0);
+    for (size_t i = 0; i < level.tileCount; ++i) {
+        int cx = static_cast<int>((level.x[i] - minX) / m_chunkSize.x);
+        int cy = static_cast<int>((level.y[i] - minY) / m_chunkSize.y);
+        std::uint32_t c = static_cast<std::uint32_t>(cy * m_chunkCols + cx);
+        tileChunk[i] = c;
+        chunkStart[c + 1]++;
+        if (tileType(level.tileNumber[i]).layer == TILE_LAYER_PLATFORM) {
+            platformCount[c]++;
+        }
+    }
+    for (std::size_t c = 1; c < chunkStart.size(); ++c) {
+        chunkStart[c] += chunkStart[c - 1];
+    }
+
+    // Tile indices grouped by chunk, in level order within each
+    std::vector<std::uint32_t> order(level.tileCount);
+    std::vector<std::uint32_t> next(chunkStart.begin(), chunkStart.end() - 1);
+    for (size_t i = 0; i < level.tileCount; ++i) {
+        order[next[tileChunk[i]]++] = static_cast<std::uint32_t>(i);
+    }
+
+    for (std::size_t c = 0; c < m_chunks.size(); ++c) {
+        Chunk& chunk = m_chunks[c];
+        std::size_t quads = chunkStart[c + 1] - chunkStart[c];
+        std::size_t decoration = 0;
+        std::size_t platform = quads - platformCount[c];
+        chunk.vertices.resize(quads * 4);
+        chunk.tiles.resize(quads);
+        chunk.decorativeCount = platform * 4;
+
+        for (std::uint32_t t = chunkStart[c]; t < chunkStart[c + 1]; ++t) {
+            std::uint32_t i = order[t];
+            int tileNumber = level.tileNumber[i];
+            std::size_t quad = tileType(tileNumber).layer == TILE_LAYER_PLATFORM ? platform++ : decoration++;
+            setQuad(&chunk.vertices[quad * 4], sf::Vector2i(level.x[i], level.y[i]), tileNumber);
+            chunk.tiles[quad] = tileNumber;
+        }
+    }
+
+    for (auto& chunk : m_chunks) {
+        chunk.buffer.setPrimitiveType(sf::Quads);
+        chunk.buffer.setUsage(sf::VertexBuffer::Static);
+        updateBounds(chunk);
+    }
+}
+
+void TileMap::setQuad(sf::Vertex* quad, sf::Vector2i position, int tileNumber) const {
+    unsigned int tilesPerRow = m_tilesetRegion.width / m_tileSize.x;
+    float u0 = static_cast<float>(m_tilesetRegion.left);
+    float v0 = static_cast<float>(m_tilesetRegion.top);
+    int tu = tileNumber % tilesPerRow;
+    int tv = tileNumber / tilesPerRow;
+    int x = position.x;
+    int y = position.y;
+
+    quad[0].position = sf::Vector2f(x, y);
+    quad[1].position = sf::Vector2f(x + m_tileSize.x, y);
+    quad[2].position = sf::Vector2f(x + m_tileSize.x, y + m_tileSize.y);
+    quad[3].position = sf::Vector2f(x, y + m_tileSize.y);
+
+    quad[0].texCoords = sf::Vector2f(u0 + tu * m_tileSize.x, v0 + tv * m_tileSize.y);
+    quad[1].texCoords = sf::Vector2f(u0 + (tu + 1) * m_tileSize.x, v0 + tv * m_tileSize.y);
+    quad[2].texCoords = sf::Vector2f(u0 + (tu + 1) * m_tileSize.x, v0 + (tv + 1) * m_tileSize.y);
+    quad[3].texCoords = sf::Vector2f(u0 + tu * m_tileSize.x, v0 + (tv + 1) * m_tileSize.y);
+
+    sf::Color color = sf::Color::White;
+    TileType type = tileType(tileNumber);
+    if (m_animateTiles && type.isAnimated()) {
+        int rate = static_cast<int>(type.framesPerSecond * 10.0f + 0.5f);
+        color = sf::Color(type.frameCount,
+                          static_cast<sf::Uint8>(std::min(std::max(rate, 0), 255)), 0);
+    }
+    for (int v = 0; v < 4; ++v) {
+        quad[v].color = color;
+    }
+}
+
+int TileMap::getTilesetTileCount() const {
+    if (m_tileSize.x == 0 || m_tileSize.y == 0) {
+        return 0;
+    }
+    return static_cast<int>((m_tilesetRegion.width / m_tileSize.x) * (m_tilesetRegion.height / m_tileSize.y));
+}
+
+const sf::Shader* TileMap::getAnimationShader() {
+    return animationShader;
+}
+
+void TileMap::setAnimationTime(float seconds) {
+    if (animationShader) {
+        animationShader->setUniform("time", seconds);
+    }
+}
+
+void TileMap::updateBounds(Chunk& chunk) const {
+    if (chunk.vertices.empty()) {
+        chunk.bounds = sf::FloatRect();
+        return;
+    }
+
+    const std::vector<sf::Vertex>& vertices = chunk.vertices;
+    float left = vertices[0].position.x;
+    float top = vertices[0].position.y;
+    float right = left;
+    float bottom = top;
+    for (std::size_t v = 1; v < vertices.size(); ++v) {
+        left = std::min(left, vertices[v].position.x);
+        top = std::min(top, vertices[v].position.y);
+        right = std::max(right, vertices[v].position.x);
+        bottom = std::max(bottom, vertices[v].position.y);
+    }
+    chunk.bounds = sf::FloatRect(left, top, right - left, bottom - top);
+}
+
+void TileMap::uploadFrom(Chunk& chunk, std::size_t first) {
+    if (!m_useVertexBuffers || first >= chunk.vertices.size()) {
+        return;
+    }
+
+    bool uploaded;
+    if (chunk.vertices.size() > chunk.buffer.getVertexCount()) {
+        // Sized to the vector's capacity, so the buffer grows as rarely as
+        // the vector does. An edited chunk is likely to be edited again.
+        chunk.buffer.setUsage(sf::VertexBuffer::Dynamic);
+        uploaded = chunk.buffer.create(chunk.vertices.capacity()) &&
+                   chunk.buffer.update(chunk.vertices.data(), chunk.vertices.size(), 0);
+    } else {
+        uploaded = chunk.buffer.update(&chunk.vertices[first], chunk.vertices.size() - first, static_cast<unsigned int>(first));
+    }
+    if (!uploaded) {
+        m_useVertexBuffers = false;
+    }
+}
+
+TileMap::Chunk* TileMap::chunkAt(sf::Vector2i position) {
+    return const_cast<Chunk*>(static_cast<const TileMap*>(this)->chunkAt(position));
+}
+
+const TileMap::Chunk* TileMap::chunkAt(sf::Vector2i position) const {
+    if (m_chunks.empty() || position.x < m_levelArea.left || position.y < m_levelArea.top ||
+        position.x > m_levelArea.left + m_levelArea.width || position.y > m_levelArea.top + m_levelArea.height) {
+        return nullptr;
+    }
+    int cx = static_cast<int>((position.x - m_levelArea.left) / m_chunkSize.x);
+    int cy = static_cast<int>((position.y - m_levelArea.top) / m_chunkSize.y);
+    return &m_chunks[cy * m_chunkCols + cx];
+}
+
+std::size_t TileMap::findTopQuad(const Chunk& chunk, sf::Vector2i position) {
+    // Later quads are drawn over earlier ones
+    sf::Vector2f corner(position.x, position.y);
+    for (std::size_t v = chunk.vertices.size(); v > 0;) {
+        v -= 4;
+        if (chunk.vertices[v].position == corner) {
+            return v;
+        }
+    }
+    return chunk.vertices.size();
+}
+
+int TileMap::getTile(sf::Vector2i position) const {
+    const Chunk* chunk = chunkAt(position);
+    if (!chunk) {
+        return -1;
+    }
+    std::size_t vertex = findTopQuad(*chunk, position);
+    return vertex < chunk->vertices.size() ? chunk->tiles[vertex / 4] : -1;
+}
+
+bool TileMap::setTile(sf::Vector2i position, int tileNumber) {
+    Chunk* chunk = chunkAt(position);
+    if (!chunk || tileNumber < 0 || tileNumber >= getTilesetTileCount()) {
+        return false;
+    }
+
+    std::size_t vertex = findTopQuad(*chunk, position);
+    if (vertex == chunk->vertices.size()) {
+        uploadFrom(*chunk, insertQuad(*chunk, position, tileNumber));
+        updateCollision(position, -1, tileNumber);
+        return true;
+    }
+
+    int oldTile = chunk->tiles[vertex / 4];
+    if (oldTile == tileNumber) {
+        return true;
+    }
+
+    if (tileType(oldTile).layer == tileType(tileNumber).layer) {
+        // Stays on the same side of the decoration/platform split, so only
+        // its texture coordinates change.
+        setQuad(&chunk->vertices[vertex], position, tileNumber);
+        chunk->tiles[vertex / 4] = tileNumber;
+        if (m_useVertexBuffers && !chunk->buffer.update(&chunk->vertices[vertex], 4, static_cast<unsigned int>(vertex))) {
+            m_useVertexBuffers = false;
+        }
+    } else {
+        eraseQuad(*chunk, vertex);
+        uploadFrom(*chunk, std::min(vertex, insertQuad(*chunk, position, tileNumber)));
+    }
+    updateCollision(position, oldTile, tileNumber);
+    return true;
+}
+
+bool TileMap::removeTile(sf::Vector2i position) {
+    Chunk* chunk = chunkAt(position);
+    if (!chunk) {
+        return false;
+    }
+
+    std::size_t vertex = findTopQuad(*chunk, position);
+    if (vertex == chunk->vertices.size()) {
+        return false;
+    }
+
+    int oldTile = chunk->tiles[vertex / 4];
+    eraseQuad(*chunk, vertex);
+    updateBounds(*chunk);
+    uploadFrom(*chunk, vertex);
+    updateCollision(position, oldTile, -1);
+    return true;
+}
+
+std::size_t TileMap::insertQuad(Chunk& chunk, sf::Vector2i position, int tileNumber) {
+    // Decorations go at the end of their part, platforms at the very end;
+    // whatever follows moves up by one quad.
+    bool platform = tileType(tileNumber).layer == TILE_LAYER_PLATFORM;
+    std::size_t vertex = platform ? chunk.vertices.size() : chunk.decorativeCount;
+
+    sf::Vertex quad[4];
+    setQuad(quad, position, tileNumber);
+    chunk.vertices.insert(chunk.vertices.begin() + vertex, quad, quad + 4);
+    chunk.tiles.insert(chunk.tiles.begin() + vertex / 4, tileNumber);
+    if (!platform) {
+        chunk.decorativeCount += 4;
+    }
+
+    if (chunk.vertices.size() == 4) {
+        chunk.bounds = sf::FloatRect(quad[0].position, quad[2].position - quad[0].position);
+    } else {
+        updateBounds(chunk);
+    }
+    return vertex;
+}
+
+void TileMap::eraseQuad(Chunk& chunk, std::size_t vertex) {
+    chunk.vertices.erase(chunk.vertices.begin() + vertex, chunk.vertices.begin() + vertex + 4);
+    chunk.tiles.erase(chunk.tiles.begin() + vertex / 4);
+    if (vertex < chunk.decorativeCount) {
+        chunk.decorativeCount -= 4;
+    }
+}
+
+void TileMap::updateCollision(sf::Vector2i position, int oldTile, int newTile) {
+    sf::FloatRect rect(position.x, position.y, m_tileSize.x, m_tileSize.y);
+
+    TileType oldType = tileType(oldTile);
+    TileType newType = tileType(newTile);
+    bool wasSolid = oldType.isSolid();
+    bool isSolid = newType.isSolid();
+    if (wasSolid && !isSolid) {
+        m_collision.removeCollisionRect(rect);
+    } else if (isSolid && !wasSolid) {
+        m_collision.addCollisionRect(rect);
+    }
+
+    bool wasCrown = oldType.isGoal();
+    bool isCrown = newType.isGoal();
+    if (wasCrown && !isCrown) {
+        m_collision.removeCrownRect(rect);
+    } else if (isCrown && !wasCrown) {
+        m_collision.addCrownRect(rect);
+    }
+}
+
+template <typename Visit>
+void TileMap::forEachVisibleChunk(const sf::FloatRect& visible, Visit visit) const {
+    m_drawnChunks = 0;
+    if (m_chunks.empty()) {
+        return;
+    }
+
+    // Tiles can hang over into the next chunk to the right and below, so
+    // the range starts one chunk early.
+    int minX = std::max(0, static_cast<int>(std::floor((visible.left - m_chunkOrigin.x) / m_chunkSize.x)) - 1);
+    int minY = std::max(0, static_cast<int>(std::floor((visible.top - m_chunkOrigin.y) / m_chunkSize.y)) - 1);
+    int maxX = std::min(m_chunkCols - 1, static_cast<int>(std::floor((visible.left + visible.width - m_chunkOrigin.x) / m_chunkSize.x)));
+    int maxY = std::min(m_chunkRows - 1, static_cast<int>(std::floor((visible.top + visible.height - m_chunkOrigin.y) / m_chunkSize.y)));
+
+    for (int cy = minY; cy <= maxY; ++cy) {
+        for (int cx = minX; cx <= maxX; ++cx) {
+            const Chunk& chunk = m_chunks[cy * m_chunkCols + cx];
+            if (chunk.vertices.empty() || !chunk.bounds.intersects(visible)) {
+                continue;
+            }
+            visit(chunk);
+            m_drawnChunks++;
+        }
+    }
+}
+
+void TileMap::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    states.transform *= getTransform();
+    states.texture = m_tileset.get();
+    if (!states.shader) {
+        states.shader = getAnimationShader();
+    }
+
+    // Visible area in map space
+    const sf::View& view = target.getView();
+    sf::FloatRect viewRect(view.getCenter() - view.getSize() / 2.f, view.getSize());
+    sf::FloatRect visible = getInverseTransform().transformRect(viewRect);
+
+    forEachVisibleChunk(visible, [&](const Chunk& chunk) {
+        if (m_useVertexBuffers) {
+            target.draw(chunk.buffer, 0, chunk.vertices.size(), states);
+        } else {
+            target.draw(chunk.vertices.data(), chunk.vertices.size(), sf::Quads, states);
+        }
+    });
+}
+
+void TileMap::batch(SpriteBatch& batch, int layer, const sf::FloatRect& visibleArea) const {
+    const sf::Transform& transform = getTransform();
+    forEachVisibleChunk(getInverseTransform().transformRect(visibleArea), [&](const Chunk& chunk) {
+        sf::Vertex* vertices = batch.append(m_tileset.get(), layer, chunk.vertices.size());
+        for (std::size_t v = 0; v < chunk.vertices.size(); ++v) {
+            vertices[v] = chunk.vertices[v];
+            vertices[v].position = transform.transformPoint(vertices[v].position);
+        }
+    });
+}
@@ -0,0 +1,133 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <vector>
+
+#include "Level.h"
+#include "SpriteBatch.h"
+#include "TileCollision.h"
+
+class TileMap : public sf::Drawable, public sf::Transformable {
+public:
+    // tileset must already be loaded: the width of region (the whole
+    // texture when empty, else e.g. the tileset's place in an atlas)
+    // decides the tile layout.
+    bool load(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const LevelView& level,
+              const sf::IntRect& region = sf::IntRect());
+
+    // load() in two halves. prepare() does all the work on the CPU and may
+    // run on any thread; upload() creates the GPU buffers and belongs on
+    // the thread that draws. Until then the map draws from its vertex
+    // arrays.
+    bool prepare(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const LevelView& level,
+                 const sf::IntRect& region = sf::IntRect());
+    void upload();
+
+    // Adds the tiles of every chunk touching visibleArea (e.g. the view's
+    // rect) to batch, instead of drawing them with a call per chunk.
+    void batch(SpriteBatch& batch, int layer, const sf::FloatRect& visibleArea) const;
+
+    // Puts tileNumber at position, the top-left corner of a tile in map
+    // space, replacing the topmost tile there or adding one if there is
+    // none. Only that tile's chunk is rewritten and uploaded, from the
+    // changed quad on, and only the collision cells under it change;
+    // platforms stay drawn over decorations. Positions outside the loaded
+    // level's extent are rejected, and so are tile numbers the tileset
+    // region does not have. The collision is shared with the World,
+    // so edit only while no simulation is ticking.
+    bool setTile(sf::Vector2i position, int tileNumber);
+
+    // Removes the topmost tile at position. False if there is none.
+    bool removeTile(sf::Vector2i position);
+
+    // Number of the topmost tile at position, or -1.
+    int getTile(sf::Vector2i position) const;
+
+    const TileCollision& getCollision() const {
+        return m_collision;
+    }
+
+    // Animated tiles (see TileType) step through their frames on the
+    // GPU: their quads carry the frame count and rate in the vertex colour
+    // and this shader moves the texture coordinates along by time, so no
+    // vertex changes from frame to frame. draw() uses it; batch() callers
+    // set it on the batch layer. One shader serves every map, so maps
+    // animate in step and share a tile width. Null before the first
+    // upload() and without shader support, in which case animated tiles
+    // show their first frame.
+    static const sf::Shader* getAnimationShader();
+
+    // Seconds the animations have run, e.g. since the round started.
+    static void setAnimationTime(float seconds);
+
+    // Number of chunks submitted by the last draw or batch call.
+    std::size_t getDrawnChunkCount() const {
+        return m_drawnChunks;
+    }
+
+    // Chunks are square blocks of CHUNK_TILES x CHUNK_TILES tile cells.
+    static const int CHUNK_TILES = 16;
+
+private:
+    // Tiles whose cell falls into one chunk: their quads, decorations first
+    // and platforms after them, mirrored into a GPU buffer. Each chunk owns
+    // its vertices so an edit never moves another chunk's.
+    struct Chunk {
+        std::vector<sf::Vertex> vertices;
+        std::vector<int> tiles; // tile number of each quad
+        std::size_t decorativeCount = 0; // vertices before the platforms
+        sf::FloatRect bounds;
+        sf::VertexBuffer buffer;
+    };
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+
+    void buildChunks(const LevelView& level);
+    void setQuad(sf::Vertex* quad, sf::Vector2i position, int tileNumber) const;
+    int getTilesetTileCount() const;
+    void updateBounds(Chunk& chunk) const;
+
+    // Uploads the chunk's vertices from first on, recreating the buffer
+    // when the chunk has outgrown it.
+    void uploadFrom(Chunk& chunk, std::size_t first);
+
+    // Chunk holding the cell at position, or null outside the level.
+    Chunk* chunkAt(sf::Vector2i position);
+    const Chunk* chunkAt(sf::Vector2i position) const;
+
+    // First vertex of the topmost quad at position, or the vertex count.
+    static std::size_t findTopQuad(const Chunk& chunk, sf::Vector2i position);
+
+    // Keep the decoration/platform order and return the first vertex
+    // that moved; the caller uploads from there.
+    std::size_t insertQuad(Chunk& chunk, sf::Vector2i position, int tileNumber);
+    void eraseQuad(Chunk& chunk, std::size_t vertex);
+    void updateCollision(sf::Vector2i position, int oldTile, int newTile);
+
+    // Calls visit for each non-empty chunk touching visible, a rect in map
+    // space, and counts them in m_drawnChunks.
+    template <typename Visit>
+    void forEachVisibleChunk(const sf::FloatRect& visible, Visit visit) const;
+
+    std::vector<Chunk> m_chunks; // m_chunkCols * m_chunkRows, row major
+    sf::Vector2f m_chunkOrigin;
+    sf::Vector2f m_chunkSize;
+    int m_chunkCols = 0;
+    int m_chunkRows = 0;
+    sf::IntRect m_levelArea; // tile corners that load() or setTile() may use
+    sf::Vector2u m_tileSize;
+    bool m_useVertexBuffers = false;
+    mutable std::size_t m_drawnChunks = 0;
+
+    // True until upload() finds that the shader cannot be used; until then
+    // animated quads get their marker colours.
+    bool m_animateTiles = true;
+
+    std::shared_ptr<const sf::Texture> m_tileset;
+    sf::IntRect m_tilesetRegion;
+    TileCollision m_collision;
+};
+
+#endif // TILEMAP_H
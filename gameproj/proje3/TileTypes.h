@@ -0,0 +1,69 @@
+#ifndef TILETYPES_H
+#define TILETYPES_H
+
+#include <array>
+#include <cstdint>
+
+// What a tile number does, looked up once per tile by the loaders and the
+// editor instead of testing number ranges. A new behaviour is a flag here
+// and a line in makeTileTypes().
+enum TileFlag : std::uint8_t {
+    TILE_SOLID = 1 << 0,   // the player and ghosts collide with it
+    TILE_ONE_WAY = 1 << 1, // solid only from above
+    TILE_HAZARD = 1 << 2,  // hurts on touch
+    TILE_GOAL = 1 << 3     // reaching it wins the round (the crown)
+};
+
+// Draw order within a map: decorations first, platforms over them.
+enum TileLayer : std::uint8_t {
+    TILE_LAYER_DECORATION,
+    TILE_LAYER_PLATFORM
+};
+
+// An animated tile shows its own number and the frameCount - 1 tiles after
+// it in the same tileset row, framesPerSecond of them a second (at most
+// 25.5, the vertex colour stores it in tenths).
+struct TileType {
+    std::uint8_t flags = 0;
+    TileLayer layer = TILE_LAYER_DECORATION;
+    std::uint8_t frameCount = 1;
+    float framesPerSecond = 0;
+
+    constexpr bool isSolid() const {
+        return (flags & TILE_SOLID) != 0;
+    }
+    constexpr bool isGoal() const {
+        return (flags & TILE_GOAL) != 0;
+    }
+    constexpr bool isAnimated() const {
+        return frameCount > 1;
+    }
+};
+
+// tilset11.png is 10 x 10 tiles of 32 px.
+const int TILE_TYPE_COUNT = 100;
+
+// Tiles 0-20 are platforms, 39 is the crown. tilset11.png has no frame
+// strips yet, so every tile is still; a strip sets e.g.
+// "types[39].frameCount = 4; types[39].framesPerSecond = 8;".
+constexpr std::array<TileType, TILE_TYPE_COUNT> makeTileTypes() {
+    std::array<TileType, TILE_TYPE_COUNT> types{};
+    for (int tile = 0; tile <= 20; ++tile) {
+        types[tile].flags = TILE_SOLID;
+        types[tile].layer = TILE_LAYER_PLATFORM;
+    }
+    types[39].flags = TILE_GOAL;
+    return types;
+}
+
+constexpr std::array<TileType, TILE_TYPE_COUNT> TILE_TYPES = makeTileTypes();
+
+// Tile numbers outside the table (and -1, "no tile") are plain decorations.
+constexpr TileType tileType(int tileNumber) {
+    return tileNumber >= 0 && tileNumber < TILE_TYPE_COUNT ? TILE_TYPES[tileNumber] : TileType();
+}
+
+static_assert(tileType(0).isSolid() && tileType(20).isSolid() && !tileType(21).isSolid(), "platform tiles");
+static_assert(tileType(39).isGoal() && !tileType(-1).isGoal(), "crown tile");
+
+#endif // TILETYPES_H
@@ -0,0 +1,48 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Hands values from one producer thread to one consumer thread without
+// locks. The producer fills back() and publishes it; the consumer takes the
+// newest published value with update() and reads it through front(). Each
+// side owns one slot and the third sits in the middle, so neither side ever
+// waits and a slow consumer just skips values.
+//
+// Slots are reused: the producer must overwrite everything it publishes.
+template <typename T>
+class TripleBuffer {
+public:
+    // Producer side.
+    T& back() {
+        return m_slots[m_back];
+    }
+
+    void publish() {
+        m_back = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Consumer side. Returns true when a newer value was taken.
+    bool update() {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& front() const {
+        return m_slots[m_front];
+    }
+
+private:
+    static const unsigned INDEX = 3;
+    static const unsigned FRESH = 4; // middle holds a value the consumer has not seen
+
+    T m_slots[3];
+    unsigned m_back = 0;
+    std::atomic<unsigned> m_middle{1};
+    unsigned m_front = 2;
+};
+
+#endif // TRIPLEBUFFER_H
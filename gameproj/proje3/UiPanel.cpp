@@ -0,0 +1,142 @@
+#include "UiPanel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const unsigned int LABEL_SIZE = 24;
+const sf::Vector2f LABEL_OFFSET(20, 10);
+const sf::Color BUTTON_COLOR = sf::Color::Red;
+const sf::Color HOVER_COLOR(255, 90, 90);
+
+}
+
+UiPanel::UiPanel(const sf::Font& font) : m_font(&font) {
+}
+
+std::size_t UiPanel::addButton(const std::string& label, const sf::FloatRect& bounds) {
+    Button button;
+    button.label = label;
+    m_buttons.push_back(button);
+    m_bounds.push_back(bounds);
+
+    if (m_buttons.size() == 1) {
+        m_area = bounds;
+    } else {
+        float left = std::min(m_area.left, bounds.left);
+        float top = std::min(m_area.top, bounds.top);
+        float right = std::max(m_area.left + m_area.width, bounds.left + bounds.width);
+        float bottom = std::max(m_area.top + m_area.height, bounds.top + bounds.height);
+        m_area = sf::FloatRect(left, top, right - left, bottom - top);
+    }
+
+    // The texture is sized to the area on the next draw
+    m_textureTried = false;
+    m_dirty = true;
+    return m_buttons.size() - 1;
+}
+
+void UiPanel::setLabel(std::size_t button, const std::string& label) {
+    if (m_buttons[button].label != label) {
+        m_buttons[button].label = label;
+        m_dirty = true;
+    }
+}
+
+void UiPanel::setVisible(std::size_t button, bool visible) {
+    if (m_buttons[button].visible != visible) {
+        m_buttons[button].visible = visible;
+        m_dirty = true;
+    }
+}
+
+void UiPanel::setEnabled(std::size_t button, bool enabled) {
+    m_buttons[button].enabled = enabled;
+    if (!enabled && m_hovered == static_cast<int>(button)) {
+        setHovered(-1);
+    }
+}
+
+int UiPanel::handleEvent(const sf::Event& event, const sf::RenderWindow& window) {
+    if (event.type == sf::Event::MouseMoved) {
+        sf::Vector2i pixel(event.mouseMove.x, event.mouseMove.y);
+        setHovered(buttonAt(window.mapPixelToCoords(pixel, window.getDefaultView())));
+    } else if (event.type == sf::Event::MouseLeft) {
+        setHovered(-1);
+    } else if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
+        sf::Vector2i pixel(event.mouseButton.x, event.mouseButton.y);
+        return buttonAt(window.mapPixelToCoords(pixel, window.getDefaultView()));
+    }
+    return -1;
+}
+
+int UiPanel::buttonAt(const sf::Vector2f& point) const {
+    for (std::size_t i = m_bounds.size(); i-- > 0;) {
+        if (m_buttons[i].visible && m_buttons[i].enabled && m_bounds[i].contains(point)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+void UiPanel::setHovered(int button) {
+    if (button != m_hovered) {
+        m_hovered = button;
+        m_dirty = true;
+    }
+}
+
+void UiPanel::rebuild() {
+    m_rects.clear();
+    m_text.clear();
+    for (std::size_t i = 0; i < m_buttons.size(); ++i) {
+        const Button& button = m_buttons[i];
+        if (!button.visible) {
+            continue;
+        }
+
+        const sf::FloatRect& rect = m_bounds[i];
+        sf::Color color = static_cast<int>(i) == m_hovered ? HOVER_COLOR : BUTTON_COLOR;
+        m_rects.push_back(sf::Vertex(sf::Vector2f(rect.left, rect.top), color));
+        m_rects.push_back(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), color));
+        m_rects.push_back(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), color));
+        m_rects.push_back(sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), color));
+
+        layoutText(*m_font, button.label, LABEL_SIZE, sf::Vector2f(rect.left, rect.top) + LABEL_OFFSET,
+                   sf::Color::White, m_text);
+    }
+}
+
+void UiPanel::draw(SpriteBatch& batch, int layer) {
+    if (!m_textureTried) {
+        m_textureTried = true;
+        m_useTexture = m_texture.create(static_cast<unsigned int>(std::ceil(m_area.width)),
+                                        static_cast<unsigned int>(std::ceil(m_area.height)));
+        m_dirty = true;
+    }
+
+    const sf::Texture& glyphs = m_font->getTexture(LABEL_SIZE);
+    if (m_dirty) {
+        m_dirty = false;
+        rebuild();
+        if (m_useTexture) {
+            // The texture's view shows the panel's area, so the vertices
+            // need no offset.
+            m_texture.setView(sf::View(m_area));
+            m_texture.clear(sf::Color::Transparent);
+            m_texture.draw(m_rects.data(), m_rects.size(), sf::Quads);
+            m_texture.draw(m_text.data(), m_text.size(), sf::Quads, sf::RenderStates(&glyphs));
+            m_texture.display();
+        }
+    }
+
+    if (m_useTexture) {
+        sf::Vector2u size = m_texture.getSize();
+        batch.addQuad(&m_texture.getTexture(), layer, sf::FloatRect(m_area.left, m_area.top, size.x, size.y),
+                      sf::IntRect(0, 0, size.x, size.y));
+    } else {
+        batch.addQuads(nullptr, layer, m_rects.data(), m_rects.size());
+        batch.addQuads(&glyphs, layer, m_text.data(), m_text.size());
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef UIPANEL_H
+#define UIPANEL_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "SpriteBatch.h"
+
+// A group of buttons drawn as one picture. The button rects share one
+// vertex array and the labels another; both are only rebuilt, and drawn
+// into a render texture, when something changes (hover, a button shown or
+// hidden, a label). Other frames queue the texture as a single quad. Hover
+// and clicks come from window events, never from polling the mouse.
+class UiPanel {
+public:
+    explicit UiPanel(const sf::Font& font);
+
+    // Buttons are drawn in the order they are added, later ones on top.
+    // Returns the new button's index.
+    std::size_t addButton(const std::string& label, const sf::FloatRect& bounds);
+
+    void setLabel(std::size_t button, const std::string& label);
+
+    // A hidden button is neither drawn nor clickable. A disabled one is
+    // drawn but ignores the mouse, e.g. while a submenu covers it.
+    void setVisible(std::size_t button, bool visible);
+    void setEnabled(std::size_t button, bool enabled);
+
+    // Updates the hover state on mouse moves and returns the index of the
+    // button clicked on a left button press, else -1. Positions are mapped
+    // through window's default view, which the panel is drawn in.
+    int handleEvent(const sf::Event& event, const sf::RenderWindow& window);
+
+    // Topmost visible, enabled button containing point, or -1.
+    int buttonAt(const sf::Vector2f& point) const;
+
+    // Queues the panel, redrawing its texture first if it changed. Without
+    // render texture support the geometry is queued instead.
+    void draw(SpriteBatch& batch, int layer);
+
+private:
+    struct Button {
+        std::string label;
+        bool visible = true;
+        bool enabled = true;
+    };
+
+    void setHovered(int button);
+    void rebuild();
+
+    const sf::Font* m_font;
+    std::vector<Button> m_buttons;
+    std::vector<sf::FloatRect> m_bounds; // parallel to m_buttons, for hit tests
+    int m_hovered = -1;
+
+    std::vector<sf::Vertex> m_rects; // one quad per visible button
+    std::vector<sf::Vertex> m_text;  // glyph quads of their labels
+    sf::FloatRect m_area;            // union of all button bounds
+    bool m_dirty = true;
+
+    sf::RenderTexture m_texture;
+    bool m_textureTried = false;
+    bool m_useTexture = false;
+};
+
+#endif // UIPANEL_H
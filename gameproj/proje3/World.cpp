@@ -0,0 +1,56 @@
+#include "World.h"
+
+World::World(const TileCollision& collision)
+    : m_collision(&collision), m_player(m_entities), m_attacker(m_entities, m_random, NORMAL, WINDOW_WIDTH) {
+}
+
+void World::start(Difficulty difficulty, std::uint64_t seed) {
+    m_random.setSeed(seed);
+    m_player.reset();
+    m_attacker.reset(difficulty);
+}
+
+bool World::tick(float deltaTime, const WorldInput& input) {
+    m_tickArena.reset();
+
+    {
+        ProfileScope scope(m_profiler, PHASE_COLLISION);
+        if (!m_collision->queryCrownRects(m_player.getBounds(), m_tickArena).empty()) {
+            return true;
+        }
+    }
+
+    {
+        ProfileScope scope(m_profiler, PHASE_PLAYER);
+        if (input.jump) {
+            m_player.jump();
+        }
+        if (input.left) {
+            m_player.moveLeft();
+        }
+        if (input.right) {
+            m_player.moveRight();
+        }
+        if (input.stop) {
+            m_player.stop();
+        }
+
+        // Also while standing: the sweep stops the fall at once and that is
+        // what keeps onGround set from one tick to the next.
+        applyGravity(m_entities, deltaTime);
+        animate(m_entities, deltaTime);
+    }
+
+    {
+        ProfileScope scope(m_profiler, PHASE_COLLISION);
+        sweepTiles(m_entities, *m_collision, deltaTime, m_tickArena);
+    }
+
+    {
+        ProfileScope scope(m_profiler, PHASE_ATTACKER);
+        m_attacker.spawn(deltaTime);
+        moveBodies(m_entities, deltaTime, m_jobs);
+        m_attacker.update(m_player, m_jobs);
+    }
+    return false;
+}
@@ -0,0 +1,96 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <SFML/Graphics.hpp>
+
+#include "Attacker.h"
+#include "FrameArena.h"
+#include "FrameProfiler.h"
+#include "GameConfig.h"
+#include "JobSystem.h"
+#include "Player.h"
+#include "Random.h"
+#include "Systems.h"
+#include "TileCollision.h"
+
+// Input for one simulation tick. left/right are held keys, jump and stop
+// are edges that happened since the previous tick.
+struct WorldInput {
+    bool left = false;
+    bool right = false;
+    bool jump = false;
+    bool stop = false;
+};
+
+// Everything the game simulates: the entities and the systems run over them
+// each tick, ghost spawning and the crown check. Does not touch a window, so
+// it runs the same headless as in the game.
+class World {
+public:
+    // collision must outlive the world or be replaced with setCollision().
+    explicit World(const TileCollision& collision);
+
+    // Starts a new round: player back at the spawn point, no ghosts. The
+    // round depends on nothing but seed and the input given to tick(), so
+    // replaying both gives the same round again.
+    void start(Difficulty difficulty, std::uint64_t seed);
+
+    // Advances the world by one fixed tick. Returns true when the player
+    // reached a crown this tick.
+    bool tick(float deltaTime, const WorldInput& input);
+
+    // Ticks from now on collide with collision instead, e.g. a reloaded
+    // level's.
+    void setCollision(const TileCollision& collision) {
+        m_collision = &collision;
+    }
+
+    // Times the player, collision and attacker phases of every tick. Null
+    // (the default) turns that off.
+    void setProfiler(FrameProfiler* profiler) {
+        m_profiler = profiler;
+    }
+
+    // Splits body movement and the ghost update across the job system's
+    // threads once there are enough ghosts for it to pay. Null (the
+    // default) keeps it serial; either way a tick gives the same result.
+    void setJobSystem(JobSystem* jobs) {
+        m_jobs = jobs;
+    }
+
+    GameEntities& getEntities() {
+        return m_entities;
+    }
+
+    const GameEntities& getEntities() const {
+        return m_entities;
+    }
+
+    Player& getPlayer() {
+        return m_player;
+    }
+
+    const Player& getPlayer() const {
+        return m_player;
+    }
+
+    Attacker& getAttacker() {
+        return m_attacker;
+    }
+
+    const Attacker& getAttacker() const {
+        return m_attacker;
+    }
+
+private:
+    const TileCollision* m_collision;
+    GameEntities m_entities; // before the player and attacker, which use it
+    Random m_random;
+    Player m_player;
+    Attacker m_attacker;
+    FrameProfiler* m_profiler = nullptr;
+    JobSystem* m_jobs = nullptr;
+    FrameArena m_tickArena; // lists that only last one tick, reset by tick()
+};
+
+#endif // WORLD_H
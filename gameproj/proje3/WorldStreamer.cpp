@@ -0,0 +1,344 @@
+#include "WorldStreamer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+bool contains(const std::vector<ChunkCoord>& coords, const ChunkCoord& coord) {
+    return std::find(coords.begin(), coords.end(), coord) != coords.end();
+}
+
+}
+
+WorldStreamer::WorldStreamer() : m_loader(&WorldStreamer::loaderLoop, this) {
+}
+
+WorldStreamer::~WorldStreamer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_loader.join();
+}
+
+bool WorldStreamer::open(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks.open(directory);
+}
+
+void WorldStreamer::setTileset(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const sf::IntRect& region) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tileset = tileset;
+        m_tileSize = tileSize;
+        m_tilesetRegion = region;
+    }
+    m_wake.notify_one();
+}
+
+void WorldStreamer::setRadius(int radius) {
+    m_radius = std::max(0, radius);
+}
+
+void WorldStreamer::setPrefetchTime(float seconds) {
+    m_prefetchTime = std::max(0.0f, seconds);
+}
+
+void WorldStreamer::setCapacity(std::size_t capacity) {
+    m_capacity = capacity;
+}
+
+std::unique_ptr<TileCollision> WorldStreamer::loadAround(const sf::Vector2f& center) {
+    std::shared_ptr<const sf::Texture> tileset;
+    sf::Vector2u tileSize;
+    sf::IntRect region;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        tileset = m_tileset;
+        tileSize = m_tileSize;
+        region = m_tilesetRegion;
+    }
+    if (!tileset) {
+        return nullptr;
+    }
+
+    m_frame++;
+    m_wanted.clear();
+    addWanted(center);
+    for (const ChunkCoord& coord : m_wanted) {
+        auto resident = std::find_if(m_resident.begin(), m_resident.end(),
+                                     [&](const Chunk& chunk) { return chunk.coord == coord; });
+        if (resident != m_resident.end()) {
+            resident->lastWanted = m_frame;
+            continue;
+        }
+        Chunk chunk = loadChunk(coord, m_chunks.chunkPath(coord), tileset, tileSize, region);
+        chunk.map->upload();
+        chunk.lastWanted = m_frame;
+        insert(std::move(chunk));
+    }
+    evict();
+    m_residentChanged = false;
+
+    std::vector<std::shared_ptr<const Level>> levels;
+    for (const Chunk& chunk : m_resident) {
+        levels.push_back(chunk.level);
+    }
+
+    // A build the loader still has running is for the old chunks; counting
+    // this as a request of its own makes update() drop it.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_collisionRequest++;
+        m_collisionRequested = false;
+        m_collisionLevels.clear();
+        m_collision.reset();
+    }
+    return buildCollision(levels, tileSize);
+}
+
+std::unique_ptr<TileCollision> WorldStreamer::update(const sf::Vector2f& center, const sf::Vector2f& velocity) {
+    m_frame++;
+    m_wanted.clear();
+    addWanted(center);
+    addWanted(center + velocity * m_prefetchTime);
+
+    // Nearest to the view first, so the loader gets to what is on screen
+    // before what is only prefetched
+    ChunkCoord middle = m_chunks.chunkAt(center.x, center.y);
+    std::sort(m_wanted.begin(), m_wanted.end(), [&](const ChunkCoord& a, const ChunkCoord& b) {
+        int da = (a.x - middle.x) * (a.x - middle.x) + (a.y - middle.y) * (a.y - middle.y);
+        int db = (b.x - middle.x) * (b.x - middle.x) + (b.y - middle.y) * (b.y - middle.y);
+        return da < db;
+    });
+
+    for (Chunk& chunk : m_resident) {
+        if (contains(m_wanted, chunk.coord)) {
+            chunk.lastWanted = m_frame;
+        }
+    }
+
+    std::unique_ptr<TileCollision> collision;
+    bool requested = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.clear();
+        for (const ChunkCoord& coord : m_wanted) {
+            if (isResident(coord) || contains(m_loading, coord)) {
+                continue;
+            }
+            bool loaded = std::any_of(m_loaded.begin(), m_loaded.end(),
+                                      [&](const Chunk& chunk) { return chunk.coord == coord; });
+            if (!loaded) {
+                m_requests.push_back(coord);
+            }
+        }
+        requested = !m_requests.empty();
+
+        m_arrived.swap(m_loaded);
+
+        if (m_collision && m_collisionBuilt == m_collisionRequest) {
+            collision = std::move(m_collision);
+        }
+        m_collision.reset();
+    }
+    if (requested) {
+        m_wake.notify_one();
+    }
+
+    // What the loader prepared gets its buffers here, on the drawing thread
+    for (Chunk& chunk : m_arrived) {
+        chunk.map->upload();
+        chunk.lastWanted = contains(m_wanted, chunk.coord) ? m_frame : m_frame - 1;
+        insert(std::move(chunk));
+    }
+    m_arrived.clear();
+    evict();
+
+    if (m_residentChanged) {
+        m_residentChanged = false;
+        requestCollision();
+    }
+    return collision;
+}
+
+void WorldStreamer::batch(SpriteBatch& batch, int layer, const sf::FloatRect& visibleArea) const {
+    for (const Chunk& chunk : m_resident) {
+        chunk.map->batch(batch, layer, visibleArea);
+    }
+}
+
+sf::FloatRect WorldStreamer::getBounds() const {
+    // Tiles reach one tile past their corner
+    float left = static_cast<float>(m_chunks.getLeft());
+    float top = static_cast<float>(m_chunks.getTop());
+    return sf::FloatRect(left, top, m_chunks.getRight() + static_cast<float>(m_tileSize.x) - left,
+                         m_chunks.getBottom() + static_cast<float>(m_tileSize.y) - top);
+}
+
+void WorldStreamer::addWanted(const sf::Vector2f& center) {
+    ChunkCoord middle = m_chunks.chunkAt(center.x, center.y);
+    for (int y = middle.y - m_radius; y <= middle.y + m_radius; ++y) {
+        for (int x = middle.x - m_radius; x <= middle.x + m_radius; ++x) {
+            ChunkCoord coord;
+            coord.x = x;
+            coord.y = y;
+            if (m_chunks.hasChunk(coord) && !contains(m_wanted, coord)) {
+                m_wanted.push_back(coord);
+            }
+        }
+    }
+}
+
+bool WorldStreamer::isResident(const ChunkCoord& coord) const {
+    return std::any_of(m_resident.begin(), m_resident.end(), [&](const Chunk& chunk) { return chunk.coord == coord; });
+}
+
+void WorldStreamer::insert(Chunk chunk) {
+    // loadAround() may have loaded it while the loader had it too
+    if (isResident(chunk.coord)) {
+        return;
+    }
+    m_resident.push_back(std::move(chunk));
+    m_residentChanged = true;
+}
+
+void WorldStreamer::evict() {
+    // Never below what the view and the prefetch point can want at once
+    std::size_t side = 2 * static_cast<std::size_t>(m_radius) + 1;
+    std::size_t capacity = std::max(m_capacity, 2 * side * side);
+
+    while (m_resident.size() > capacity) {
+        std::size_t oldest = m_resident.size();
+        for (std::size_t i = 0; i < m_resident.size(); ++i) {
+            if (m_resident[i].lastWanted < m_frame &&
+                (oldest == m_resident.size() || m_resident[i].lastWanted < m_resident[oldest].lastWanted)) {
+                oldest = i;
+            }
+        }
+        if (oldest == m_resident.size()) {
+            break;
+        }
+
+        // The map's buffers go with it; the loader may still hold the level
+        // for a collision build.
+        std::swap(m_resident[oldest], m_resident.back());
+        m_resident.pop_back();
+        m_residentChanged = true;
+    }
+}
+
+void WorldStreamer::requestCollision() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_collisionLevels.clear();
+        for (const Chunk& chunk : m_resident) {
+            m_collisionLevels.push_back(chunk.level);
+        }
+        m_collisionRequest++;
+        m_collisionRequested = true;
+    }
+    m_wake.notify_one();
+}
+
+WorldStreamer::Chunk WorldStreamer::loadChunk(const ChunkCoord& coord, const std::string& path,
+                                              std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize,
+                                              const sf::IntRect& region) {
+    // A chunk that cannot be read stays resident empty rather than being
+    // asked for again every frame.
+    std::shared_ptr<Level> level = std::make_shared<Level>();
+    if (!level->loadBinary(path)) {
+        std::cerr << "Could not load level chunk " << path << std::endl;
+        level = std::make_shared<Level>();
+    }
+
+    Chunk chunk;
+    chunk.coord = coord;
+    chunk.map.reset(new TileMap());
+    chunk.map->prepare(tileset, tileSize, level->view(), region);
+    chunk.level = level;
+    return chunk;
+}
+
+std::unique_ptr<TileCollision> WorldStreamer::buildCollision(const std::vector<std::shared_ptr<const Level>>& levels,
+                                                             sf::Vector2u tileSize) {
+    std::size_t tileCount = 0;
+    for (const auto& level : levels) {
+        tileCount += level->view().tileCount;
+    }
+
+    std::vector<std::int32_t> x;
+    std::vector<std::int32_t> y;
+    std::vector<std::int32_t> tileNumber;
+    x.reserve(tileCount);
+    y.reserve(tileCount);
+    tileNumber.reserve(tileCount);
+    for (const auto& level : levels) {
+        const LevelView& view = level->view();
+        x.insert(x.end(), view.x, view.x + view.tileCount);
+        y.insert(y.end(), view.y, view.y + view.tileCount);
+        tileNumber.insert(tileNumber.end(), view.tileNumber, view.tileNumber + view.tileCount);
+    }
+
+    Level merged;
+    merged.assign(std::move(x), std::move(y), std::move(tileNumber));
+    std::unique_ptr<TileCollision> collision(new TileCollision());
+    collision->build(merged.view(), tileSize);
+    return collision;
+}
+
+void WorldStreamer::loaderLoop() {
+    while (true) {
+        std::shared_ptr<const sf::Texture> tileset;
+        sf::Vector2u tileSize;
+        sf::IntRect region;
+        std::vector<std::shared_ptr<const Level>> levels;
+        std::uint64_t collisionRequest = 0;
+        bool buildingCollision = false;
+        ChunkCoord coord;
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] {
+                return m_stopping || (m_tileset && (m_collisionRequested || !m_requests.empty()));
+            });
+            if (m_stopping) {
+                return;
+            }
+            tileset = m_tileset;
+            tileSize = m_tileSize;
+            region = m_tilesetRegion;
+
+            // The collision is for chunks already on screen, so it goes
+            // before chunks that are not
+            if (m_collisionRequested) {
+                m_collisionRequested = false;
+                levels.swap(m_collisionLevels);
+                collisionRequest = m_collisionRequest;
+                buildingCollision = true;
+            } else {
+                coord = m_requests.front();
+                m_requests.erase(m_requests.begin());
+                m_loading.push_back(coord);
+                path = m_chunks.chunkPath(coord);
+            }
+        }
+
+        if (buildingCollision) {
+            std::unique_ptr<TileCollision> collision = buildCollision(levels, tileSize);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (collisionRequest == m_collisionRequest) {
+                m_collision = std::move(collision);
+                m_collisionBuilt = collisionRequest;
+            }
+        } else {
+            Chunk chunk = loadChunk(coord, path, tileset, tileSize, region);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_loading.erase(std::find(m_loading.begin(), m_loading.end(), coord));
+            m_loaded.push_back(std::move(chunk));
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef WORLDSTREAMER_H
+#define WORLDSTREAMER_H
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Level.h"
+#include "LevelChunks.h"
+#include "SpriteBatch.h"
+#include "TileCollision.h"
+#include "TileMap.h"
+
+// Pages the chunks of a LevelChunks level in and out around the camera, so
+// that only a bounded part of a level of any size is in memory. A chunk is
+// resident with its tiles, its TileMap (vertex buffers) and its share of
+// the collision together. Files are read and maps prepared on the
+// streamer's own thread; the frame loop only uploads finished chunks and
+// swaps in the collision the thread merged from the resident ones.
+class WorldStreamer {
+public:
+    WorldStreamer();
+    ~WorldStreamer();
+
+    WorldStreamer(const WorldStreamer&) = delete;
+    WorldStreamer& operator=(const WorldStreamer&) = delete;
+
+    // Reads the chunk index in directory. Call before setTileset().
+    bool open(const std::string& directory);
+
+    // What chunk maps are built with, as for TileMap::load. Nothing is
+    // loaded before this has been called.
+    void setTileset(std::shared_ptr<const sf::Texture> tileset, sf::Vector2u tileSize, const sf::IntRect& region);
+
+    // Chunks up to radius chunks away from the view centre are wanted, and
+    // as many around the point the camera reaches in prefetchTime seconds
+    // at its current velocity. At most capacity chunks stay resident (never
+    // fewer than can be wanted at once); the ones least recently wanted go
+    // first.
+    void setRadius(int radius);
+    void setPrefetchTime(float seconds);
+    void setCapacity(std::size_t capacity);
+
+    // Loads the chunks around center on this thread, e.g. for the start of
+    // a round, and returns their collision. Null before setTileset().
+    std::unique_ptr<TileCollision> loadAround(const sf::Vector2f& center);
+
+    // Call once a frame on the thread that draws. Asks the loader for the
+    // chunks now wanted, uploads those that arrived and evicts over
+    // capacity. Returns the collision of the resident chunks when it has
+    // changed since the last call, else null; hand it to the world before
+    // the previous one is destroyed.
+    std::unique_ptr<TileCollision> update(const sf::Vector2f& center, const sf::Vector2f& velocity);
+
+    // Adds the resident tiles touching visibleArea to batch, see
+    // TileMap::batch. Animated tiles need TileMap::getAnimationShader() on
+    // the layer.
+    void batch(SpriteBatch& batch, int layer, const sf::FloatRect& visibleArea) const;
+
+    // The pixels the whole level covers, resident or not.
+    sf::FloatRect getBounds() const;
+
+    std::size_t getResidentCount() const {
+        return m_resident.size();
+    }
+
+private:
+    struct Chunk {
+        ChunkCoord coord;
+        std::shared_ptr<const Level> level;
+        std::unique_ptr<TileMap> map;
+        std::uint64_t lastWanted = 0; // m_frame when it was last wanted
+    };
+
+    void loaderLoop();
+    static Chunk loadChunk(const ChunkCoord& coord, const std::string& path, std::shared_ptr<const sf::Texture> tileset,
+                           sf::Vector2u tileSize, const sf::IntRect& region);
+    static std::unique_ptr<TileCollision> buildCollision(const std::vector<std::shared_ptr<const Level>>& levels,
+                                                         sf::Vector2u tileSize);
+
+    // Adds the present chunks within m_radius of center to m_wanted.
+    void addWanted(const sf::Vector2f& center);
+    bool isResident(const ChunkCoord& coord) const;
+    void insert(Chunk chunk);
+    void evict();
+    void requestCollision();
+
+    LevelChunks m_chunks;
+    int m_radius = 1;
+    float m_prefetchTime = 0.5f;
+    std::size_t m_capacity = 0;
+    std::uint64_t m_frame = 0;
+    std::vector<Chunk> m_resident;
+    std::vector<ChunkCoord> m_wanted; // reused by update()
+    std::vector<Chunk> m_arrived;     // reused by update()
+    bool m_residentChanged = false;
+
+    // Shared with the loader thread. Requests are replaced wholesale every
+    // frame, so chunks that stopped being wanted before the loader got to
+    // them are never read. A collision build replaces any still pending.
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::shared_ptr<const sf::Texture> m_tileset;
+    sf::Vector2u m_tileSize;
+    sf::IntRect m_tilesetRegion;
+    std::vector<ChunkCoord> m_requests; // nearest first
+    std::vector<ChunkCoord> m_loading;  // taken by the loader, not finished yet
+    std::vector<Chunk> m_loaded;
+    std::vector<std::shared_ptr<const Level>> m_collisionLevels;
+    bool m_collisionRequested = false;
+    std::uint64_t m_collisionRequest = 0; // numbers the requests
+    std::unique_ptr<TileCollision> m_collision;
+    std::uint64_t m_collisionBuilt = 0; // request m_collision was built for
+
+    std::thread m_loader;
+};
+
+#endif // WORLDSTREAMER_H
@@ -1,484 +1,190 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
-#include <tuple>
-#include <cstdlib>
+#include <algorithm>
+#include <cstdio>
 #include <ctime>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <sys/stat.h>
 #include <SFML/Audio.hpp>
 
-const int WINDOW_WIDTH = 800;
-const int WINDOW_HEIGHT = 600;
-const int GAME_WIDTH = 1600;
-const int GAME_HEIGHT = 1200;
-
-enum GameState {
-    MENU,
-    GAME,
-    WIN,
-    EXIT
-};
-
-enum Difficulty {
-    NORMAL,
-    HARD
+#include "AllocationTracker.h"
+#include "FrameProfiler.h"
+#include "GameConfig.h"
+#include "HotReloader.h"
+#include "HudText.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "Level.h"
+#include "ParallaxBackground.h"
+#include "Random.h"
+#include "ResourceManager.h"
+#include "Simulation.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "TileMap.h"
+#include "UiPanel.h"
+#include "World.h"
+#include "WorldStreamer.h"
+
+// SpriteBatch layers, drawn in this order. Everything in the world layer
+// comes from the one atlas texture.
+enum DrawLayer {
+    DRAW_BACKGROUND,
+    DRAW_WORLD,
+    DRAW_TEXT
 };
 
-class Button {
-public:
-    sf::RectangleShape shape;
-    sf::Text text;
-
-    Button(const std::string& label, const sf::Font& font, float x, float y) {
-        text.setFont(font);
-        text.setString(label);
-        text.setCharacterSize(24);
-        text.setFillColor(sf::Color::White);
-        text.setPosition(x + 20, y + 10);
-
-        shape.setSize(sf::Vector2f(250, 50));
-        shape.setFillColor(sf::Color::Red);
-        shape.setPosition(x, y);
-    }
-
-    void draw(sf::RenderWindow& window) {
-        window.draw(shape);
-        window.draw(text);
-    }
-
-    bool isClicked(sf::Vector2i mousePos) {
-        return shape.getGlobalBounds().contains(static_cast<sf::Vector2f>(mousePos));
-    }
-
-    void setLabel(const std::string& label) {
-        text.setString(label);
-    }
-};
+// Game frames a round runs before --alloc-trap starts flagging allocations:
+// enough for glyph caches, batch streams and snapshots to reach their size.
+const std::size_t ALLOCATION_WARMUP_FRAMES = 120;
 
 class Win {
-private:
-    std::vector<Button> WinButtons;
 public:
-    Win(sf::Font& font) {
-        WinButtons.push_back(Button("Menu", font, 275, 400));
-        WinButtons.push_back(Button("Play again", font, 275, 500));
+    Win(const sf::Font& font) : panel(font) {
+        panel.addButton("Menu", sf::FloatRect(275, 400, 250, 50));
+        panel.addButton("Play again", sf::FloatRect(275, 500, 250, 50));
     }
 
-    void draw(sf::RenderWindow& window) {
-        for (auto& button : WinButtons) {
-            button.draw(window);
-        }
+    void draw(SpriteBatch& batch) {
+        panel.draw(batch, DRAW_BACKGROUND);
     }
 
-    int handleClick(sf::RenderWindow& window, sf::Vector2i mousePos) {
-        sf::Vector2f worldPos = window.mapPixelToCoords(mousePos, window.getDefaultView());
-        for (size_t i = 0; i < WinButtons.size(); ++i) {
-            if (WinButtons[i].isClicked(static_cast<sf::Vector2i>(worldPos))) {
-                return i;
-            }
-        }
-        return -1;
-    }
-};
-
-class SubMenu {
-public:
-    SubMenu(sf::Font& font) {
-        buttons.push_back(Button("Normal", font, 300, 400));
-        buttons.push_back(Button("Hard", font, 300, 500));
-    }
-
-    void draw(sf::RenderWindow& window) {
-        for (auto& button : buttons) {
-            button.draw(window);
-        }
-    }
-
-    int handleClick(sf::Vector2i mousePos) {
-        for (size_t i = 0; i < buttons.size(); ++i) {
-            if (buttons[i].isClicked(mousePos)) {
-                return i;
-            }
-        }
-        return -1;
+    // 0 for Menu, 1 for Play again, else -1
+    int handleEvent(const sf::Event& event, const sf::RenderWindow& window) {
+        return panel.handleEvent(event, window);
     }
 
 private:
-    std::vector<Button> buttons;
+    UiPanel panel;
 };
 
 class Menu {
 public:
-    Menu(sf::Font& font) : showSubMenu(false), subMenu(font) {
-        buttons.push_back(Button("Start", font, 300, 200));
-        buttons.push_back(Button("Select Game Mode", font, 300, 300));
-        buttons.push_back(Button("Exit", font, 300, 400));
-    }
-
-    void draw(sf::RenderWindow& window) {
-        for (auto& button : buttons) {
-            button.draw(window);
-        }
-        if (showSubMenu) {
-            subMenu.draw(window);
-        }
-    }
-
-    int handleClick(sf::Vector2i mousePos) {
-        if (showSubMenu) {
-            int subMenuIndex = subMenu.handleClick(mousePos);
-            if (subMenuIndex != -1) {
-                showSubMenu = false;
-                return subMenuIndex + 3; // Offset by 3 to distinguish from main menu buttons
-            }
-        }
-        else {
-            for (size_t i = 0; i < buttons.size(); ++i) {
-                if (buttons[i].isClicked(mousePos)) {
-                    if (i == 1) {
-                        showSubMenu = true;
-                        return -1;
-                    }
-                    return i;
-                }
-            }
-        }
-        return -1;
-    }
-
-private:
-    std::vector<Button> buttons;
-    bool showSubMenu;
-    SubMenu subMenu;
-};
-
-class Player {
-public:
-    sf::Sprite sprite;
-    sf::Texture texture;
-    float velocityY;
-    float velocityX;
-    bool onGround;
-    sf::IntRect currentFrame;
-    sf::Clock animationClock;
-    float animationTime;
-    int currentFrameIndex;
-    int jumpCount = 0;
-
-    Player(const std::string& textureFile) : velocityY(0), velocityX(200.0f), onGround(false), currentFrameIndex(0), animationTime(0.1f) {
-        if (!texture.loadFromFile(textureFile)) {
-            std::cerr << "Error loading player texture!" << std::endl;
-        }
-        sprite.setTexture(texture);
-        sprite.setTextureRect(sf::IntRect(0, 0, 32, 32)); // Assume each frame is 32x32 pixels
-        sprite.setPosition(1, 1100);
-    }
-
-    void update(float deltaTime) {
-        // Apply gravity
-        if (!onGround) {
-            velocityY += 981.0f * deltaTime; // gravity in pixels/s^2
-        }
-
-        // Apply horizontal movement
-        sprite.move(velocityX * deltaTime, velocityY * deltaTime);
-
-        // Update animation
-        updateAnimation(deltaTime);
-    }
-
-    void jump() {
-        if (jumpCount < 2) {
-            velocityY = -600.0f; // jump velocity
-            onGround = false;
-            jumpCount++;
-        }
-    }
-
-    void moveLeft() {
-        velocityX = -200.0f; // move speed
-        sprite.setScale(-1, 1); // Flip sprite horizontally
-        sprite.setOrigin(sprite.getLocalBounds().width, 0); // Set origin to right side
-    }
-
-    void moveRight() {
-        velocityX = 200.0f; // move speed
-        sprite.setScale(1, 1); // Reset sprite scale
-        sprite.setOrigin(0, 0); // Reset origin to default (left side)
-    }
-
-    void stop() {
-        velocityX = 0.0f;
-    }
-
-    void updateAnimation(float deltaTime) {
-        // Update only if the time elapsed is greater than animationTime
-        if (animationClock.getElapsedTime().asSeconds() >= animationTime) {
-            if (onGround) {
-                currentFrameIndex = (currentFrameIndex + 1) % 2;
-                currentFrame = sf::IntRect(currentFrameIndex * 32, 0 * 32, 32, 32);
-            } else {
-                currentFrameIndex = (currentFrameIndex + 1) % 8;
-                currentFrame = sf::IntRect(currentFrameIndex * 32, 5 * 32, 32, 32);
-            }
-
-            sprite.setTextureRect(currentFrame);
-            animationClock.restart();
-        }
-    }
-
-    void handleCollision(const sf::FloatRect& platformBounds) {
-        sf::FloatRect playerBounds = sprite.getGlobalBounds();
-
-        if (playerBounds.intersects(platformBounds)) {
-            float playerBottom = playerBounds.top + playerBounds.height;
-            float platformTop = platformBounds.top;
-            float playerTop = playerBounds.top;
-            float platformBottom = platformBounds.top + platformBounds.height;
-            float playerRight = playerBounds.left + playerBounds.width;
-            float platformLeft = platformBounds.left;
-            float playerLeft = playerBounds.left;
-            float platformRight = platformBounds.left + platformBounds.width;
-
-            float overlapBottom = playerBottom - platformTop;
-            float overlapTop = platformBottom - playerTop;
-            float overlapRight = playerRight - platformLeft;
-            float overlapLeft = platformRight - playerLeft;
-
-            bool fromBottom = overlapBottom < overlapTop && overlapBottom < overlapRight && overlapBottom < overlapLeft;
-            bool fromTop = overlapTop < overlapBottom && overlapTop < overlapRight && overlapTop < overlapLeft;
-            bool fromRight = overlapRight < overlapLeft && overlapRight < overlapTop && overlapRight < overlapBottom;
-            bool fromLeft = overlapLeft < overlapRight && overlapLeft < overlapTop && overlapLeft < overlapBottom;
-
-            if (fromBottom) {
-                sprite.setPosition(sprite.getPosition().x, platformBounds.top - playerBounds.height);
-                velocityY = 0;
-                onGround = true;
-                jumpCount = 0;
-            } else if (fromTop) {
-                sprite.setPosition(sprite.getPosition().x, platformBounds.top + platformBounds.height);
-                velocityY = 0;
-            } else if (fromRight) {
-                sprite.setPosition(platformBounds.left - playerBounds.width, sprite.getPosition().y);
-            } else if (fromLeft) {
-                sprite.setPosition(platformBounds.left + platformBounds.width, sprite.getPosition().y);
-            }
-        }
-    }
-
-    void caught() {
-        sprite.setPosition(1, 1100);
-        velocityY = 0;
-        velocityX = 200.0f;
-        jumpCount = 0;
-    }
-
-
-    void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
-    }
-};
-
-
-class Attacker {
-public:
-    Attacker(Difficulty dif) : spawnClock() {
-        if(dif == HARD){
-            spawnInterval = 0.5f;
-        }else if(dif == NORMAL){
-            spawnInterval = 1.0f;
+    // The game mode buttons are part of the same panel, hidden until
+    // "Select Game Mode" shows them over the buttons below it.
+    Menu(const sf::Font& font) : panel(font) {
+        panel.addButton("Start", sf::FloatRect(300, 200, 250, 50));
+        panel.addButton("Select Game Mode", sf::FloatRect(300, 300, 250, 50));
+        panel.addButton("Exit", sf::FloatRect(300, 400, 250, 50));
+        panel.addButton("Normal", sf::FloatRect(300, 400, 250, 50));
+        panel.addButton("Hard", sf::FloatRect(300, 500, 250, 50));
+        setShowSubMenu(false);
+    }
+
+    void draw(SpriteBatch& batch) {
+        panel.draw(batch, DRAW_BACKGROUND);
+    }
+
+    // 0 for Start, 2 for Exit, 3 and 4 for Normal and Hard, else -1
+    int handleEvent(const sf::Event& event, const sf::RenderWindow& window) {
+        int button = panel.handleEvent(event, window);
+        if (button == 1) {
+            setShowSubMenu(true);
+            return -1;
         }
-        captureSpeed = 200.0f; // Speed at which ghost moves towards the player
-        if (!ghostTexture.loadFromFile("E:/szkola/Programowanie/c++/gameproj/proje3/assets/ghost.png")) {
-            std::cerr << "Error loading ghost texture!" << std::endl;
+        if (button >= 3) {
+            setShowSubMenu(false);
         }
+        return button;
     }
 
-    void update(float deltaTime, Player& player, sf::RenderWindow& window) {
-        if (spawnClock.getElapsedTime().asSeconds() >= spawnInterval) {
-            spawnClock.restart();
-            spawnGhost(window);
-        }
-
-        for (auto it = ghosts.begin(); it != ghosts.end(); ) {
-            moveGhost(*it, deltaTime);
-            if (it->getGlobalBounds().intersects(player.sprite.getGlobalBounds())) {
-                capturePlayer(player);
-                it = ghosts.erase(it); // Remove ghost upon capturing player
-            } else if (it->getPosition().y >= 1200) {
-                it = ghosts.erase(it); // Remove ghost if it reaches the bottom of the screen
-            } else {
-                ++it;
-            }
-        }
-    }
-
-    void draw(sf::RenderWindow& window) {
-        for (const auto& ghost : ghosts) {
-            window.draw(ghost);
-        }
-    }
-
-private:
-    sf::Clock spawnClock;
-    float spawnInterval;
-    float captureSpeed;
-    std::vector<sf::Sprite> ghosts;
-    sf::Texture ghostTexture;
-
-    void spawnGhost(sf::RenderWindow& window) {
-        sf::Sprite ghost;
-        ghost.setTexture(ghostTexture);
-        ghost.setTextureRect(sf::IntRect(0, 0, 32, 32));
-        float x = static_cast<float>(rand() % window.getSize().x);
-        ghost.setPosition(x, 0); // Spawn at the top of the window
-        ghosts.push_back(ghost);
-        std::cout << "Spawned ghost at x: " << x << std::endl; // Debug output
-    }
-
-    void moveGhost(sf::Sprite& ghost, float deltaTime) {
-        ghost.move(0, captureSpeed * deltaTime);
-    }
-
-    void capturePlayer(Player& player) {
-        player.caught();
-    }
-};
-
-
-class ParallaxBackground {
 private:
-    sf::Sprite sprite;
-    sf::Texture texture;
-    float parallaxFactor;
-
-public:
-    ParallaxBackground(const std::string& filePath, float parallaxFactor) : parallaxFactor(parallaxFactor) {
-        if (!texture.loadFromFile(filePath)) {
-            std::cerr << "Could not load texture" << filePath << "!" << std::endl;
+    // While the submenu shows, only its buttons take clicks
+    void setShowSubMenu(bool show) {
+        for (std::size_t i = 0; i < 3; ++i) {
+            panel.setEnabled(i, !show);
         }
-        sprite.setTexture(texture);
-        sprite.setScale(
-            static_cast<float>(GAME_WIDTH) / texture.getSize().x,
-            static_cast<float>(GAME_HEIGHT) / texture.getSize().y
-            );
+        panel.setVisible(3, show);
+        panel.setVisible(4, show);
     }
 
-    void update(const sf::View& view) {
-        sf::Vector2f viewCenter = view.getCenter();
-        sprite.setPosition(viewCenter.x * parallaxFactor - WINDOW_WIDTH * parallaxFactor / 2,
-                           viewCenter.y * parallaxFactor - WINDOW_HEIGHT * parallaxFactor / 2);
-    }
-
-    void draw(sf::RenderWindow& window) {
-        window.draw(sprite);
-    }
+    UiPanel panel;
 };
 
-class TileMap : public sf::Drawable, public sf::Transformable {
-public:
-    bool load(const std::string& tileset, sf::Vector2u tileSize, const std::vector<std::tuple<int, int, int>>& tiles) {
-        if (!m_tileset.loadFromFile(tileset))
-            return false;
-
-        m_vertices.setPrimitiveType(sf::Quads);
-        m_vertices.resize(tiles.size() * 4);
-
-        size_t platformCount = 0;
-        size_t decorativeCount = 0;
-
-        for (const auto& tile : tiles) {
-            int tileNumber = std::get<2>(tile);
-            if (tileNumber >= 0 && tileNumber <= 20) {
-                platformCount++;
-            }
-            else {
-                decorativeCount++;
-            }
-        }
-
-        size_t platformIndex = decorativeCount * 4;
-        size_t decorativeIndex = 0;
-
-        for (size_t i = 0; i < tiles.size(); ++i) {
-            int x, y, tileNumber;
-            std::tie(x, y, tileNumber) = tiles[i];
-
-            int tu = tileNumber % (m_tileset.getSize().x / tileSize.x);
-            int tv = tileNumber / (m_tileset.getSize().x / tileSize.x);
-
-            sf::Vertex* quad;
-
-            if (tileNumber >= 0 && tileNumber <= 20) {
-                quad = &m_vertices[platformIndex];
-                platformIndex += 4;
-                m_collisionRects.push_back(sf::FloatRect(x, y, tileSize.x, tileSize.y));
-            }
-            else {
-                quad = &m_vertices[decorativeIndex];
-                decorativeIndex += 4;
-            }
-
-            if (tileNumber == 39) {
-                m_crownRects.push_back(sf::FloatRect(x, y, tileSize.x, tileSize.y));
-            }
-
-            quad[0].position = sf::Vector2f(x, y);
-            quad[1].position = sf::Vector2f(x + tileSize.x, y);
-            quad[2].position = sf::Vector2f(x + tileSize.x, y + tileSize.y);
-            quad[3].position = sf::Vector2f(x, y + tileSize.y);
-
-            quad[0].texCoords = sf::Vector2f(tu * tileSize.x, tv * tileSize.y);
-            quad[1].texCoords = sf::Vector2f((tu + 1) * tileSize.x, tv * tileSize.y);
-            quad[2].texCoords = sf::Vector2f((tu + 1) * tileSize.x, (tv + 1) * tileSize.y);
-            quad[3].texCoords = sf::Vector2f(tu * tileSize.x, (tv + 1) * tileSize.y);
-        }
+// Modification time of path, or -1 if it does not exist.
+long long modifiedTime(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<long long>(info.st_mtime) : -1;
+}
 
+// tile_data.lvl is produced from tile_data.txt by levelconv; the text
+// file is only parsed when the binary level is missing, broken or older
+// than the text (edited since the last conversion). path is set to the
+// file that was loaded.
+bool loadLevel(Level& level, const std::string& assetDir, std::string& path) {
+    path = assetDir + "tile_data.lvl";
+    if (modifiedTime(path) >= modifiedTime(assetDir + "tile_data.txt") && level.loadBinary(path)) {
         return true;
     }
-
-    const std::vector<sf::FloatRect>& getCollisionRects() const {
-        return m_collisionRects;
+    path = assetDir + "tile_data.txt";
+    if (level.loadText(path)) {
+        return true;
     }
+    std::cerr << "Could not load level" << std::endl;
+    return false;
+}
 
-    const std::vector<sf::FloatRect>& getCrownRects() const {
-        return m_crownRects;
+// "--replay <file>": plays a round saved with F5 without a window, as fast
+// as it goes, and prints how it ended and how long it took.
+int replayHeadless(const std::string& filePath, const std::string& assetDir) {
+    InputRecording recording;
+    if (!recording.load(filePath)) {
+        std::cerr << "Could not load recording " << filePath << std::endl;
+        return -1;
     }
 
-private:
-    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const {
-        states.transform *= getTransform();
-        states.texture = &m_tileset;
-        target.draw(m_vertices, states);
+    Level level;
+    std::string levelPath;
+    if (!loadLevel(level, assetDir, levelPath)) {
+        return -1;
     }
+    TileCollision collision;
+    collision.build(level.view(), sf::Vector2u(32, 32));
 
-    sf::VertexArray m_vertices;
-    sf::Texture m_tileset;
-    std::vector<sf::FloatRect> m_collisionRects;
-    std::vector<sf::FloatRect> m_crownRects;
-};
+    World world(collision);
+    JobSystem jobs;
+    world.setJobSystem(&jobs);
 
+    sf::Clock clock;
+    std::size_t ticks = replay(world, recording);
+    float ms = clock.getElapsedTime().asSeconds() * 1000.0f;
+
+    sf::Vector2f position = world.getPlayer().getPosition();
+    std::cout << "Replayed " << ticks << " of " << recording.getTickCount() << " ticks in " << ms << " ms"
+              << (ticks < recording.getTickCount() ? ", reached a crown" : "") << ", player at ("
+              << position.x << ", " << position.y << "), " << world.getAttacker().getGhostCount() << " ghosts"
+              << std::endl;
+    return 0;
+}
 
+int main(int argc, char* argv[]) {
 
-std::vector<std::tuple<int, int, int>> loadTileData(const std::string& filePath) {
-    std::vector<std::tuple<int, int, int>> tiles;
-    std::ifstream file(filePath);
-    std::string line;
+    // Assets are read and decoded on worker threads while the level loads
+    // and the window opens. Only the font is needed before the menu shows.
+    const std::string assetDir = "E:/szkola/Programowanie/c++/gameproj/proje3/assets/";
 
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        int x, y, tileNumber;
-        if (iss >> x >> y >> tileNumber) {
-            tiles.emplace_back(x, y, tileNumber);
-        }
+    if (argc == 3 && std::string(argv[1]) == "--replay") {
+        return replayHeadless(argv[2], assetDir);
     }
 
-    return tiles;
-}
+    // "--alloc-trap": once a round has warmed up, any heap allocation made
+    // during a game frame or a simulation tick is reported (and asserted on
+    // in debug builds), see NoAllocationScope.
+    bool allocationTrap = argc == 2 && std::string(argv[1]) == "--alloc-trap";
+    ResourceManager resources;
+    bool texturesReloaded = false; // since the atlas was built
+    resources.setLoadHook([&texturesReloaded](const AssetLoadInfo& info) {
+        std::cout << info.path << ": read " << info.readTime << " ms, upload " << info.uploadTime
+                  << " ms, ready after " << info.totalTime << " ms" << std::endl;
+        texturesReloaded = true;
+    });
 
-
-int main() {
+    std::shared_ptr<sf::Font> font = resources.requestFont(assetDir + "arial.ttf");
+    std::shared_ptr<sf::Texture> tilesetTexture = resources.requestTexture(assetDir + "tilset11.png");
+    std::shared_ptr<sf::Texture> backgroundTexture = resources.requestTexture(assetDir + "background1.png");
+    std::shared_ptr<sf::Texture> playerTexture = resources.requestTexture(assetDir + "AnimationSheet_Character.png");
+    std::shared_ptr<sf::Texture> ghostTexture = resources.requestTexture(assetDir + "ghost.png");
+    std::shared_ptr<sf::Texture> winTexture = resources.requestTexture(assetDir + "win.png");
 
     // sf::Music music;
     // if (!music.openFromFile("E:/szkola/Programowanie/c++/gameproj/proje3/assets/sound.ogg")) {
@@ -486,193 +192,395 @@ int main() {
     //     return -1;
     // }
 
-    std::vector<std::tuple<int, int, int>> tiles = loadTileData("E:/szkola/Programowanie/c++/gameproj/proje3/assets/tile_data.txt");
-
-    TileMap tileMap;
-    if (!tileMap.load("E:/szkola/Programowanie/c++/gameproj/proje3/assets/tilset11.png", sf::Vector2u(32, 32), tiles)) {
-        std::cerr << "Could not load tileset" << std::endl;
+    // A level split up by "levelconv --chunks" into assets/world is streamed
+    // in around the camera, so only a few chunks of it are ever in memory.
+    // Otherwise the whole of tile_data is loaded up front.
+    WorldStreamer streamer;
+    bool streaming = streamer.open(assetDir + "world");
+    streamer.setRadius(1);
+    streamer.setPrefetchTime(0.5f);
+    streamer.setCapacity(32);
+
+    Level level;
+    std::string levelPath;
+    if (!streaming && !loadLevel(level, assetDir, levelPath)) {
         return -1;
     }
 
-    sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Jumper Keng");
-    window.setFramerateLimit(60);
+    // Saving the level or an image while the game runs shows the change
+    // within a frame or two.
+    HotReloader reloader(resources);
+    if (!streaming) {
+        reloader.watchLevel(assetDir + "tile_data.lvl");
+        reloader.watchLevel(assetDir + "tile_data.txt");
+    }
+    reloader.watchTexture(assetDir + "tilset11.png");
+    reloader.watchTexture(assetDir + "background1.png");
+    reloader.watchTexture(assetDir + "AnimationSheet_Character.png");
+    reloader.watchTexture(assetDir + "ghost.png");
+    reloader.watchTexture(assetDir + "win.png");
 
-    ParallaxBackground parallaxBackground("E:/szkola/Programowanie/c++/gameproj/proje3/assets/background1.png", 0.5f);
+    sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Jumper Keng");
+    window.setVerticalSyncEnabled(true);
 
-    sf::Font font;
-    if (!font.loadFromFile("E:/szkola/Programowanie/c++/gameproj/proje3/assets/arial.ttf")) {
+    if (resources.wait(assetDir + "arial.ttf") != ASSET_READY) {
         std::cerr << "Could not load font" << std::endl;
         return -1;
     }
 
-    sf::Text positionText;
-    positionText.setFont(font);
-    positionText.setCharacterSize(24);
-    positionText.setFillColor(sf::Color::Black);
-    positionText.setPosition(10, 10);
+    // Filled in by prepareGame once the tileset has arrived, replaced
+    // whenever the level is reloaded. Stays empty while streaming.
+    std::unique_ptr<TileMap> tileMap(new TileMap());
 
-    Player player("E:/szkola/Programowanie/c++/gameproj/proje3/assets/AnimationSheet_Character.png");
+    // While streaming, the collision of the resident chunks the world
+    // currently uses
+    std::unique_ptr<TileCollision> streamedCollision;
+    sf::Vector2f cameraVelocity; // of the last frame, for the prefetch
 
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
+    // Scrolls at half the level's speed, one copy stretched over the level.
+    // Further layers go on top of it at no extra cost per frame.
+    ParallaxBackground parallaxBackground;
+    parallaxBackground.addLayer(backgroundTexture, 0.5f, sf::Vector2f(GAME_WIDTH, GAME_HEIGHT));
 
-    sf::Clock clock;
+    // Drives the animated tiles' frames on the GPU
+    sf::Clock animationClock;
 
-    Menu menu(font);
+    // Laid out once; only the height digits change from frame to frame
+    HudText heightText(*font, 24, sf::Vector2f(10, 10), sf::Color::Black);
+    heightText.setString("Y: ");
+
+    World world(tileMap->getCollision());
+    JobSystem jobs;
+    world.setJobSystem(&jobs);
+
+    // Every round gets its own seed; F5 saves it with the round's input
+    Random roundSeeds(static_cast<std::uint64_t>(std::time(nullptr)));
+    std::size_t roundFrames = 0; // game frames since the round started
+
+    // From here on the world belongs to the simulation thread; this thread
+    // only draws the snapshots it publishes.
+    Simulation simulation(world, SIM_TICK_RATE, SIM_MAX_STEPS_PER_FRAME);
+    simulation.setAllocationTrap(allocationTrap);
+    unsigned seenWins = 0;
+
+    Menu menu(*font);
     GameState gameState = MENU;
     Difficulty difficulty = NORMAL;
 
-    Win winScreen(font);
-    sf::Sprite winSprite;
+    Win winScreen(*font);
+
+    // Player, ghost, tile and win images share one texture, so the world
+    // layer is a single draw call.
+    TextureAtlas atlas;
+    TextureRegion playerSheet;
+    TextureRegion ghostImage;
+    TextureRegion winImage;
+
+    // The menu runs while the game assets stream in. Whatever is still
+    // missing when a game starts is waited for then.
+    bool gameReady = false;
+    auto prepareGame = [&]() {
+        if (gameReady) {
+            return true;
+        }
+        resources.waitAll();
 
-    sf::Texture winTexture;
-    if (!winTexture.loadFromFile("E:/szkola/Programowanie/c++/gameproj/proje3/assets/win.png")) {
-        std::cerr << "Couldnt load texture" << std::endl;
-        return -1;
-    }
+        if (resources.getState(assetDir + "win.png") != ASSET_READY) {
+            std::cerr << "Couldnt load texture" << std::endl;
+            return false;
+        }
+        if (resources.getState(assetDir + "tilset11.png") != ASSET_READY) {
+            std::cerr << "Could not load tileset" << std::endl;
+            return false;
+        }
 
-    winSprite.setTexture(winTexture);
-    winSprite.setPosition((WINDOW_WIDTH - winTexture.getSize().x) / 2, (WINDOW_HEIGHT - winTexture.getSize().y) / 2);
+        atlas.add("player", playerTexture);
+        atlas.add("ghost", ghostTexture);
+        atlas.add("tiles", tilesetTexture);
+        atlas.add("win", winTexture);
+        if (!atlas.build()) {
+            return false;
+        }
+        playerSheet = atlas.getRegion("player");
+        ghostImage = atlas.getRegion("ghost");
+        winImage = atlas.getRegion("win");
+
+        if (streaming) {
+            streamer.setTileset(atlas.getTexture(), sf::Vector2u(32, 32), atlas.getRegion("tiles").rect);
+            simulation.setLevelBounds(streamer.getBounds());
+        } else if (!tileMap->load(atlas.getTexture(), sf::Vector2u(32, 32), level.view(), atlas.getRegion("tiles").rect)) {
+            std::cerr << "Could not load tileset" << std::endl;
+            return false;
+        }
+        reloader.setTileset(atlas.getTexture(), sf::Vector2u(32, 32), atlas.getRegion("tiles").rect);
+        texturesReloaded = false;
+        gameReady = true;
+        return true;
+    };
+
+    // The chunks around the spawn point are loaded before the first tick,
+    // the rest follow the camera.
+    auto startRound = [&]() {
+        if (streaming) {
+            std::unique_ptr<TileCollision> collision = streamer.loadAround(sf::Vector2f(PLAYER_SPAWN_X, PLAYER_SPAWN_Y));
+            if (collision) {
+                simulation.setCollision(*collision);
+                streamedCollision.swap(collision);
+            }
+        }
+        gameState = GAME;
+        simulation.start(difficulty, roundSeeds.next());
+        roundFrames = 0;
+    };
 
     // music.play();
 
     sf::View view(sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT));
     window.setView(view);
 
-    Attacker attacker(difficulty);
+    // Key edges seen since the last frame
+    WorldInput pendingInput;
+
+    // F3 toggles the overlay, F4 writes the recorded frames to
+    // profile.csv and profile.json (Chrome trace), and the simulation
+    // thread's to profile_sim.csv and profile_sim.json. F5 saves the
+    // round's input to replay.inp for "--replay replay.inp".
+    FrameProfiler profiler;
+    bool showProfiler = false;
+    HudText profilerText(*font, 14, sf::Vector2f(WINDOW_WIDTH - 200, 10), sf::Color::Black);
+    sf::Clock profilerTextClock;
+
+    // Every draw goes through here; each flush is one call per texture
+    SpriteBatch batch;
+    batch.setProfiler(&profiler);
 
     while (window.isOpen()) {
-        float deltaTime = clock.restart().asSeconds();
+        profiler.beginFrame();
+
+        profiler.begin(PHASE_EVENTS);
+        resources.update();
+        if (gameState == MENU && resources.getPendingCount() == 0 && !prepareGame()) {
+            return -1;
+        }
+
+        if (gameReady) {
+            std::unique_ptr<LevelReload> reload = reloader.update();
+
+            // Reloaded images only reach the screen through a new atlas. The
+            // tile map keeps the old atlas texture alive and showing until
+            // it is rebuilt against the new one.
+            if (texturesReloaded && resources.getPendingCount() == 0) {
+                texturesReloaded = false;
+                if (atlas.build()) {
+                    playerSheet = atlas.getRegion("player");
+                    ghostImage = atlas.getRegion("ghost");
+                    winImage = atlas.getRegion("win");
+                    reloader.setTileset(atlas.getTexture(), sf::Vector2u(32, 32), atlas.getRegion("tiles").rect);
+                    if (streaming) {
+                        // Resident chunks keep the old atlas until evicted
+                        streamer.setTileset(atlas.getTexture(), sf::Vector2u(32, 32), atlas.getRegion("tiles").rect);
+                    } else {
+                        reloader.reloadLevel(levelPath);
+                    }
+                }
+            }
+
+            // The map was built on the reloader's thread; what is left is
+            // the buffer upload and telling the simulation, which waits at
+            // most for the ticks it is running.
+            if (reload) {
+                sf::Clock swapClock;
+                reload->tileMap->upload();
+                simulation.setCollision(reload->tileMap->getCollision());
+                tileMap.swap(reload->tileMap);
+                levelPath = reload->path;
+                std::cout << reload->path << ": built " << reload->buildTime << " ms, swapped in "
+                          << swapClock.getElapsedTime().asSeconds() * 1000.0f << " ms, "
+                          << reload->sinceChange.getElapsedTime().asSeconds() * 1000.0f << " ms after the change"
+                          << std::endl;
+            }
+
+            // Chunks come and go like the reloads above, outside the
+            // allocation-free part of the frame. The world gets the new
+            // collision before the old one is destroyed.
+            if (streaming && gameState == GAME) {
+                std::unique_ptr<TileCollision> collision = streamer.update(window.getView().getCenter(), cameraVelocity);
+                if (collision) {
+                    simulation.setCollision(*collision);
+                    streamedCollision.swap(collision);
+                }
+            }
+        }
+
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed)
                 window.close();
 
+            if (event.type == sf::Event::KeyPressed) {
+                if (event.key.code == sf::Keyboard::F3) {
+                    showProfiler = !showProfiler;
+                } else if (event.key.code == sf::Keyboard::F4) {
+                    profiler.writeCsv("profile.csv");
+                    profiler.writeChromeTrace("profile.json");
+                    simulation.requestProfileDump("profile_sim");
+                } else if (event.key.code == sf::Keyboard::F5) {
+                    simulation.requestRecordingSave("replay.inp");
+                }
+            }
+
             if (gameState == MENU) {
-                if (event.type == sf::Event::MouseButtonPressed) {
-                    int buttonIndex = menu.handleClick(sf::Mouse::getPosition(window));
-                    if (buttonIndex == 0) {
-                        gameState = GAME;
-                    } else if (buttonIndex == 1) {
-
-                    } else if (buttonIndex == 2) {
-                        gameState = EXIT;
-                    } else if (buttonIndex == 3) {
-                        difficulty = NORMAL;
-                    } else if (buttonIndex == 4) {
-                        difficulty = HARD;
+                int buttonIndex = menu.handleEvent(event, window);
+                if (buttonIndex == 0) {
+                    if (!prepareGame()) {
+                        return -1;
                     }
+                    startRound();
+                } else if (buttonIndex == 2) {
+                    gameState = EXIT;
+                } else if (buttonIndex == 3) {
+                    difficulty = NORMAL;
+                } else if (buttonIndex == 4) {
+                    difficulty = HARD;
                 }
             } else if (gameState == GAME) {
                 if (event.type == sf::Event::KeyPressed) {
                     if (event.key.code == sf::Keyboard::Space) {
-                        player.jump();
+                        pendingInput.jump = true;
                     }
                 }
-            }
-            else if (gameState == WIN) {
-                if (event.type == sf::Event::MouseButtonPressed) {
-                    int buttonIndex = winScreen.handleClick(window, sf::Mouse::getPosition(window));
-                    if (buttonIndex == 0) {
-                        gameState = MENU;
-                        window.setView(window.getDefaultView()); // Reset view to default
-                    }
-                    else if (buttonIndex == 1) {
-                        gameState = GAME;
+                if (event.type == sf::Event::KeyReleased) {
+                    if (event.key.code == sf::Keyboard::Left || event.key.code == sf::Keyboard::Right) {
+                        pendingInput.stop = true;
                     }
                 }
             }
-        }
-
-        if (gameState == EXIT) {
-            window.close();
-        } else if (gameState == GAME) {
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
-                player.moveLeft();
-            }
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-                player.moveRight();
-            }
-            if (event.type == sf::Event::KeyReleased) {
-                if (event.key.code == sf::Keyboard::Left || event.key.code == sf::Keyboard::Right) {
-                    player.stop();
+            else if (gameState == WIN) {
+                int buttonIndex = winScreen.handleEvent(event, window);
+                if (buttonIndex == 0) {
+                    gameState = MENU;
+                    window.setView(window.getDefaultView()); // Reset view to default
                 }
-            }
-
-            for (const auto& rect : tileMap.getCrownRects()) {
-                sf::FloatRect playerBounds = player.sprite.getGlobalBounds();
-                if (playerBounds.intersects(rect)) {
-                    gameState = WIN;
+                else if (buttonIndex == 1) {
+                    startRound();
                 }
             }
+        }
 
-            player.update(deltaTime);
+        profiler.end(PHASE_EVENTS);
 
-            player.onGround = false;
+        // Event polling is SFML's and stays outside; the rest of a
+        // steady-state frame should not allocate.
+        if (gameState == GAME) {
+            roundFrames++;
+        }
+        NoAllocationScope allocationScope(allocationTrap && gameState == GAME && roundFrames > ALLOCATION_WARMUP_FRAMES);
+
+        if (gameState == GAME) {
+            pendingInput.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Left);
+            pendingInput.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Right);
+            simulation.setInput(pendingInput);
+            // The simulation keeps edges until a tick has seen them
+            pendingInput.jump = false;
+            pendingInput.stop = false;
+        }
 
-            for (const auto& rect : tileMap.getCollisionRects()) {
-                player.handleCollision(rect);
+        // Newest state from the simulation thread, drawn between its last
+        // two ticks
+        const FrameSnapshot& frame = simulation.latest();
+        float alpha = frame.alpha();
+        if (frame.wins != seenWins) {
+            seenWins = frame.wins;
+            if (gameState == GAME) {
+                gameState = WIN;
             }
+        }
 
+        if (gameState == EXIT) {
+            window.close();
+        } else if (gameState == GAME) {
+            ProfileScope viewScope(&profiler, PHASE_VIEW);
 
             sf::View view = window.getView();
-            sf::Vector2f playerPosition = player.sprite.getPosition();
-            sf::Vector2f viewCenter = playerPosition;
-
-            if (viewCenter.x < WINDOW_WIDTH / 2.0f) {
-                viewCenter.x = WINDOW_WIDTH / 2.0f;
-            }
-            if (viewCenter.x > GAME_WIDTH - WINDOW_WIDTH / 2.0f) {
-                viewCenter.x = GAME_WIDTH - WINDOW_WIDTH / 2.0f;
-            }
-
-            if (viewCenter.y < WINDOW_HEIGHT / 2.0f) {
-                viewCenter.y = WINDOW_HEIGHT / 2.0f;
-            }
-            if (viewCenter.y > GAME_HEIGHT - WINDOW_HEIGHT / 2.0f) {
-                viewCenter.y = GAME_HEIGHT - WINDOW_HEIGHT / 2.0f;
-            }
-
-            view.setCenter(viewCenter);
+            view.setCenter(frame.previousViewCenter + (frame.viewCenter - frame.previousViewCenter) * alpha);
             window.setView(view);
+            cameraVelocity = (frame.viewCenter - frame.previousViewCenter) / frame.step;
 
-
-            parallaxBackground.update(view);
-
-            int yDiv100 = static_cast<int>(playerPosition.y) / 100;
-            std::ostringstream ss;
-            ss << "Y: " << yDiv100;
-            positionText.setString(ss.str());
-
-            attacker.update(deltaTime, player, window);
+            TileMap::setAnimationTime(animationClock.getElapsedTime().asSeconds());
+            heightText.setNumber(frame.heightMarker);
         }
 
-        window.clear();
-        parallaxBackground.draw(window);
-        window.draw(tileMap);
-        window.draw(player.sprite);
-        window.draw(positionText);
-        attacker.draw(window);
+        if (showProfiler && profilerTextClock.getElapsedTime().asSeconds() > 0.25f) {
+            profilerTextClock.restart();
+            // Fixed width fields keep the text the same length, so once it
+            // has been shown it is laid out again without allocating
+            char text[512];
+            int length = std::snprintf(text, sizeof(text), "frame %6.2f ms\n", profiler.getAverageFrameTime());
+            for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+                // The world phases run on the simulation thread; show its
+                // latest pass, which may hold several ticks or none
+                bool simulated = phase == PHASE_PLAYER || phase == PHASE_COLLISION || phase == PHASE_ATTACKER;
+                float ms = simulated ? frame.simFrame.phaseTime[phase] / 1000.0f
+                                     : profiler.getAveragePhaseTime(static_cast<ProfilePhase>(phase));
+                length += std::snprintf(text + length, sizeof(text) - length, "%s %6.2f ms\n",
+                                        profilePhaseName(static_cast<ProfilePhase>(phase)), ms);
+            }
+            std::snprintf(text + length, sizeof(text) - length, "draw calls %5.1f\nvertices %6.0f\nallocs %5.1f, sim %3u",
+                          profiler.getAverageDrawCalls(), profiler.getAverageVertices(),
+                          profiler.getAverageAllocations(), frame.simFrame.allocations);
+            profilerText.setString(text);
+        }
 
-        if (gameState == WIN) {
-            window.clear();
-            player.sprite.setPosition(1, 1100);
-            winSprite.setPosition(view.getCenter().x - 100, view.getCenter().y - 200);
-            winSprite.setScale(0.85,0.75);
+        profiler.begin(PHASE_DRAW);
 
-            window.draw(winSprite);
+        window.clear();
+        if (gameState == GAME) {
+            const sf::View& gameView = window.getView();
+            profiler.addDrawCalls(parallaxBackground.draw(window));
+            sf::FloatRect visibleArea(gameView.getCenter() - gameView.getSize() / 2.f, gameView.getSize());
+            batch.setLayerShader(DRAW_WORLD, TileMap::getAnimationShader());
+            if (streaming) {
+                streamer.batch(batch, DRAW_WORLD, visibleArea);
+            } else {
+                tileMap->batch(batch, DRAW_WORLD, visibleArea);
+            }
+            frame.player.batch(batch, DRAW_WORLD, playerSheet, alpha);
+            frame.ghosts.batch(batch, DRAW_WORLD, ghostImage, alpha);
+            heightText.batch(batch, DRAW_TEXT);
+            batch.flush(window);
+        }
+        else if (gameState == WIN) {
+            batch.addQuad(winImage.texture, DRAW_WORLD,
+                          sf::FloatRect(view.getCenter().x - 100, view.getCenter().y - 200, winImage.rect.width * 0.85f, winImage.rect.height * 0.75f),
+                          winImage.rect);
+            batch.flush(window);
 
             window.setView(window.getDefaultView());
-            winScreen.draw(window);
+            winScreen.draw(batch);
+            batch.flush(window);
 
             window.setView(view);
 
         }
         else if (gameState == MENU) {
-            window.clear();
             window.setView(window.getDefaultView());
-            menu.draw(window);
+            menu.draw(batch);
+            batch.flush(window);
         }
+
+        if (showProfiler) {
+            sf::View gameView = window.getView();
+            window.setView(window.getDefaultView());
+            profilerText.batch(batch, DRAW_TEXT);
+            batch.flush(window);
+            window.setView(gameView);
+        }
+        profiler.end(PHASE_DRAW);
+
+        profiler.begin(PHASE_PRESENT);
         window.display();
+        profiler.end(PHASE_PRESENT);
+        profiler.endFrame();
 
     }
 
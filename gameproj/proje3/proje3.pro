@@ -13,6 +13,65 @@ CONFIG(debug, debug|release){
 }
 
 SOURCES += \
+        AabbBatch.cpp \
+        AllocationTracker.cpp \
+        Attacker.cpp \
+        FileWatcher.cpp \
+        FrameArena.cpp \
+        FrameProfiler.cpp \
+        HotReloader.cpp \
+        HudText.cpp \
+        InputRecording.cpp \
+        JobSystem.cpp \
+        Level.cpp \
+        LevelChunks.cpp \
+        MappedFile.cpp \
+        ParallaxBackground.cpp \
+        Player.cpp \
+        ResourceManager.cpp \
+        Simulation.cpp \
+        SpatialGrid.cpp \
+        SpriteBatch.cpp \
+        Systems.cpp \
+        TextureAtlas.cpp \
+        TileCollision.cpp \
+        TileMap.cpp \
+        UiPanel.cpp \
+        World.cpp \
+        WorldStreamer.cpp \
         main.cpp
 
-HEADERS +=
+HEADERS += \
+    AabbBatch.h \
+    AllocationTracker.h \
+    Attacker.h \
+    Components.h \
+    EntityStore.h \
+    FileWatcher.h \
+    FixedTimestep.h \
+    FrameArena.h \
+    FrameProfiler.h \
+    GameConfig.h \
+    HotReloader.h \
+    HudText.h \
+    InputRecording.h \
+    JobSystem.h \
+    Level.h \
+    LevelChunks.h \
+    MappedFile.h \
+    ParallaxBackground.h \
+    Player.h \
+    Random.h \
+    ResourceManager.h \
+    Simulation.h \
+    SpatialGrid.h \
+    SpriteBatch.h \
+    Systems.h \
+    TextureAtlas.h \
+    TileCollision.h \
+    TileMap.h \
+    TileTypes.h \
+    TripleBuffer.h \
+    UiPanel.h \
+    World.h \
+    WorldStreamer.h
@@ -0,0 +1,167 @@
+#include "SpatialHash.h"
+
+#include <algorithm>
+#include <cmath>
+
+unsigned contactMask(const sf::FloatRect &wall_bounds, const sf::FloatRect &guy_bounds)
+{
+    const float m = CONTACT_MARGIN;
+    float guy_left = guy_bounds.left;
+    float guy_right = guy_bounds.left + guy_bounds.width;
+    float guy_top = guy_bounds.top;
+    float guy_bottom = guy_bounds.top + guy_bounds.height;
+    float wall_left = wall_bounds.left;
+    float wall_right = wall_bounds.left + wall_bounds.width;
+    float wall_top = wall_bounds.top;
+    float wall_bottom = wall_bounds.top + wall_bounds.height;
+
+    // Every side test needs the rectangles within the margin of each other
+    if (guy_right < wall_left - m || guy_left > wall_right + m || guy_bottom < wall_top - m || guy_top > wall_bottom + m)
+    {
+        return 0;
+    }
+
+    unsigned mask = 0;
+    if (guy_bottom >= wall_top - m && guy_top < wall_bottom && guy_right > wall_left + m && guy_left < wall_right - m)
+    {
+        mask |= CONTACT_TOP;
+    }
+    if (guy_right >= wall_left - m && guy_left <= wall_right && guy_bottom > wall_top + m && guy_top < wall_bottom - m)
+    {
+        mask |= CONTACT_LEFT;
+    }
+    if (guy_top <= wall_bottom + m && guy_bottom >= wall_top && guy_right > wall_left - m && guy_left < wall_right + m)
+    {
+        mask |= CONTACT_BOTTOM;
+    }
+    if (guy_left <= wall_right + m && guy_right >= wall_left && guy_bottom > wall_top - m && guy_top < wall_bottom + m)
+    {
+        mask |= CONTACT_RIGHT;
+    }
+    return mask;
+}
+
+SpatialHash::SpatialHash(float cell_size) : m_cell_size(cell_size), m_buckets(1024)
+{
+}
+
+void SpatialHash::clear()
+{
+    m_bounds.clear();
+    for (auto &bucket : m_buckets)
+    {
+        bucket.clear();
+    }
+    m_entry_count = 0;
+    m_seen.clear();
+}
+
+std::size_t SpatialHash::insert(const sf::FloatRect &bounds)
+{
+    std::uint32_t id = static_cast<std::uint32_t>(m_bounds.size());
+    m_bounds.push_back(bounds);
+    m_seen.push_back(0);
+
+    int min_x, min_y, max_x, max_y;
+    cellRange(bounds, min_x, min_y, max_x, max_y);
+    for (int y = min_y; y <= max_y; y++)
+    {
+        for (int x = min_x; x <= max_x; x++)
+        {
+            m_buckets[bucketOf(x, y)].push_back(Entry{x, y, id});
+            m_entry_count++;
+        }
+    }
+
+    if (m_entry_count > m_buckets.size() * 2)
+    {
+        grow();
+    }
+    return id;
+}
+
+void SpatialHash::build(const std::vector<sf::Sprite> &obstacles)
+{
+    clear();
+    for (const auto &obstacle : obstacles)
+    {
+        insert(obstacle.getGlobalBounds());
+    }
+}
+
+void SpatialHash::query(const sf::FloatRect &area, std::vector<std::size_t> &result) const
+{
+    if (m_bounds.empty())
+    {
+        return;
+    }
+
+    // A new stamp per query; after it wraps around, start the stamps over
+    m_query++;
+    if (m_query == 0)
+    {
+        std::fill(m_seen.begin(), m_seen.end(), 0);
+        m_query = 1;
+    }
+
+    int min_x, min_y, max_x, max_y;
+    cellRange(area, min_x, min_y, max_x, max_y);
+    for (int y = min_y; y <= max_y; y++)
+    {
+        for (int x = min_x; x <= max_x; x++)
+        {
+            for (const Entry &entry : m_buckets[bucketOf(x, y)])
+            {
+                // Other cells can hash into the same bucket
+                if (entry.cell_x != x || entry.cell_y != y || m_seen[entry.id] == m_query)
+                {
+                    continue;
+                }
+                m_seen[entry.id] = m_query;
+                result.push_back(entry.id);
+            }
+        }
+    }
+}
+
+unsigned SpatialHash::contacts(const sf::FloatRect &bounds) const
+{
+    sf::FloatRect area(bounds.left - CONTACT_MARGIN, bounds.top - CONTACT_MARGIN,
+                       bounds.width + 2 * CONTACT_MARGIN, bounds.height + 2 * CONTACT_MARGIN);
+    m_scratch.clear();
+    query(area, m_scratch);
+
+    unsigned mask = 0;
+    for (std::size_t id : m_scratch)
+    {
+        mask |= contactMask(m_bounds[id], bounds);
+    }
+    return mask;
+}
+
+std::size_t SpatialHash::bucketOf(int cell_x, int cell_y) const
+{
+    std::uint32_t hash = static_cast<std::uint32_t>(cell_x) * 73856093u ^ static_cast<std::uint32_t>(cell_y) * 19349663u;
+    return hash & (m_buckets.size() - 1);
+}
+
+void SpatialHash::cellRange(const sf::FloatRect &area, int &min_x, int &min_y, int &max_x, int &max_y) const
+{
+    min_x = static_cast<int>(std::floor(area.left / m_cell_size));
+    min_y = static_cast<int>(std::floor(area.top / m_cell_size));
+    max_x = static_cast<int>(std::floor((area.left + area.width) / m_cell_size));
+    max_y = static_cast<int>(std::floor((area.top + area.height) / m_cell_size));
+}
+
+void SpatialHash::grow()
+{
+    std::vector<std::vector<Entry>> old_buckets(m_buckets.size() * 2);
+    old_buckets.swap(m_buckets);
+    for (const auto &bucket : old_buckets)
+    {
+        for (const Entry &entry : bucket)
+        {
+            m_buckets[bucketOf(entry.cell_x, entry.cell_y)].push_back(entry);
+        }
+    }
+}
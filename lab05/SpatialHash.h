@@ -0,0 +1,88 @@
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include <cstdint>
+#include <vector>
+
+#include <SFML/Graphics.hpp>
+
+// Sides of a mover that are blocked by a wall, as bits of a contact mask.
+enum ContactSide
+{
+    CONTACT_TOP = 1 << 0,
+    CONTACT_LEFT = 1 << 1,
+    CONTACT_BOTTOM = 1 << 2,
+    CONTACT_RIGHT = 1 << 3
+};
+
+// Tolerance of the side tests in pixels: a wall this close counts as touching.
+const float CONTACT_MARGIN = 3.f;
+
+// The four side tests in one go: which sides of guy_bounds wall_bounds
+// blocks. Same conditions as the old Collision_T/L/B/R, with the edges of
+// both rectangles worked out once.
+unsigned contactMask(const sf::FloatRect &wall_bounds, const sf::FloatRect &guy_bounds);
+
+// Broad phase for static obstacles. Every wall is stored in each grid cell
+// its bounds touch, and the cells are hashed into a bucket table that
+// doubles once it holds more than two entries per bucket, so the grid
+// needs no size and can be as large as the world. A query only
+// looks at the cells around the area, so its cost depends on the walls
+// nearby and not on how many walls there are.
+class SpatialHash
+{
+public:
+    // cell_size should be around the size of a mover or a wall.
+    explicit SpatialHash(float cell_size = 64.f);
+
+    void clear();
+
+    // Adds a wall and returns its id, the index into bounds().
+    std::size_t insert(const sf::FloatRect &bounds);
+
+    // Replaces the contents with the global bounds of every obstacle; ids
+    // are their indices.
+    void build(const std::vector<sf::Sprite> &obstacles);
+
+    // Appends the ids of the walls whose cells touch area, each once.
+    // Callers still test the bounds themselves.
+    void query(const sf::FloatRect &area, std::vector<std::size_t> &result) const;
+
+    // contactMask of bounds against every wall near it.
+    unsigned contacts(const sf::FloatRect &bounds) const;
+
+    const sf::FloatRect &bounds(std::size_t id) const
+    {
+        return m_bounds[id];
+    }
+
+    std::size_t size() const
+    {
+        return m_bounds.size();
+    }
+
+private:
+    struct Entry
+    {
+        int cell_x;
+        int cell_y;
+        std::uint32_t id;
+    };
+
+    std::size_t bucketOf(int cell_x, int cell_y) const;
+    void cellRange(const sf::FloatRect &area, int &min_x, int &min_y, int &max_x, int &max_y) const;
+    void grow();
+
+    float m_cell_size;
+    std::vector<sf::FloatRect> m_bounds;
+    std::vector<std::vector<Entry>> m_buckets; // power of two count
+    std::size_t m_entry_count = 0;
+
+    // Stamps for dropping duplicates of walls that span several cells,
+    // without sorting or a set
+    mutable std::vector<std::uint32_t> m_seen;
+    mutable std::uint32_t m_query = 0;
+    mutable std::vector<std::size_t> m_scratch;
+};
+
+#endif // SPATIALHASH_H
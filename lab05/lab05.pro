@@ -13,4 +13,8 @@ CONFIG(debug, debug|release){
 }
 
 SOURCES += \
+        SpatialHash.cpp \
         main.cpp
+
+HEADERS += \
+    SpatialHash.h
@@ -1,9 +1,15 @@
+#include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <SFML/Window.hpp>
 #include <SFML/Graphics.hpp>
 
+#include "SpatialHash.h"
+
 
 class CustomSprite : public sf::Sprite
 {
@@ -18,106 +24,206 @@ public:
     }
 
 
-    bool Collision_T(sf::FloatRect wall_bounds, sf::FloatRect guy_bounds)
+    // Arrow keys; a side blocked by a wall or the bounds does not move.
+    void moveInDirection(const sf::Time &elapsed, const SpatialHash &walls)
     {
-        if ((guy_bounds.top+guy_bounds.height >= wall_bounds.top - 3) && (guy_bounds.top < wall_bounds.top + wall_bounds.height)
-            && (guy_bounds.left+guy_bounds.width > wall_bounds.left + 3) && (guy_bounds.left < wall_bounds.left+wall_bounds.width - 3))
-        {
-            return 1;
-        }
-        else{return 0;}
-
+        unsigned contacts = walls.contacts(getGlobalBounds());
+        moveTowards(elapsed, contacts,
+                    sf::Keyboard::isKeyPressed(sf::Keyboard::Right), sf::Keyboard::isKeyPressed(sf::Keyboard::Left),
+                    sf::Keyboard::isKeyPressed(sf::Keyboard::Up), sf::Keyboard::isKeyPressed(sf::Keyboard::Down));
     }
 
-    bool Collision_L(sf::FloatRect wall_bounds, sf::FloatRect guy_bounds)
+    // contacts is a contact mask (see contactMask) of the sides walls block.
+    // Left wins over right and down over up when both are asked for.
+    void moveTowards(const sf::Time &elapsed, unsigned contacts, bool go_right, bool go_left, bool go_up, bool go_down)
     {
-        if((guy_bounds.left + guy_bounds.width >= wall_bounds.left - 3) && (guy_bounds.left <= wall_bounds.left + wall_bounds.width)
-            && (guy_bounds.top + guy_bounds.height > wall_bounds.top + 3) && (guy_bounds.top < wall_bounds.top + wall_bounds.height - 3))
-        {
-            return 1;
+        sf::FloatRect rectangle_bounds = getGlobalBounds();
+
+        sf::Vector2f movement(0.f, 0.f);
+
+        if (go_right && (rectangle_bounds.left + rectangle_bounds.width < bound_right) && !(contacts & CONTACT_RIGHT)) {
+            movement.x = m_speed_x * elapsed.asSeconds() * 1;
         }
-        else{return 0;}
 
-    }
+        if (go_left && (rectangle_bounds.left > bound_left) && !(contacts & CONTACT_LEFT)) {
+            movement.x = m_speed_x * elapsed.asSeconds() * -1;
+        }
 
-    bool Collision_B(sf::FloatRect wall_bounds, sf::FloatRect guy_bounds)
-    {
-        if((guy_bounds.top <= wall_bounds.top + wall_bounds.height + 3) && (guy_bounds.top + guy_bounds.height >= wall_bounds.top )
-            && (guy_bounds.left + guy_bounds.width > wall_bounds.left - 3) && (guy_bounds.left < wall_bounds.left + wall_bounds.width + 3))
-        {
-            return 1;
+        if (go_up && (rectangle_bounds.top > bound_top) && !(contacts & CONTACT_TOP)) {
+            movement.y = m_speed_y * elapsed.asSeconds() * -1;
+        }
+
+        if (go_down && (rectangle_bounds.top + rectangle_bounds.height < bound_bottom) && !(contacts & CONTACT_BOTTOM)) {
+            movement.y = m_speed_y * elapsed.asSeconds() * 1;
         }
-        else{return 0;}
 
+        move(movement);
     }
 
-    bool Collision_R(sf::FloatRect wall_bounds, sf::FloatRect guy_bounds)
+    void setSpeed(int speed_x, int speed_y)
     {
-        if((guy_bounds.left <= wall_bounds.left + wall_bounds.width + 3) && (guy_bounds.left + guy_bounds.width >= wall_bounds.left)
-            && (guy_bounds.top + guy_bounds.height > wall_bounds.top - 3) && (guy_bounds.top < wall_bounds.top + wall_bounds.height + 3))
-        {
-            return 1;
-        }
-        else{return 0;}
-
+        m_speed_x = speed_x;
+        m_speed_y = speed_y;
     }
 
-    // add other collison checking sides here
 
+private:
+    int m_speed_x = 200;
+    int m_speed_y = 200;
+    int bound_top = 0;
+    int bound_bottom = 0;
+    int bound_left = 0;
+    int bound_right = 0;
+};
 
-    void moveInDirection(const sf::Time &elapsed, const std::vector<sf::Sprite> &obstacles)
-    {
+// Four corners of rect as a textured quad, the texture repeated over it.
+void addQuad(sf::VertexArray &quads, const sf::FloatRect &rect, const sf::Vector2f &tex_size)
+{
+    quads.append(sf::Vertex(sf::Vector2f(rect.left, rect.top), sf::Vector2f(0, 0)));
+    quads.append(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), sf::Vector2f(tex_size.x, 0)));
+    quads.append(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), tex_size));
+    quads.append(sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), sf::Vector2f(0, tex_size.y)));
+}
 
+struct Mover
+{
+    CustomSprite sprite;
+    int dir_x = 0; // -1, 0 or 1
+    int dir_y = 0;
+    float turn_in = 0; // seconds until it picks a new direction
+};
 
-        bool top=0, left=0, bottom=0, right=0;
-        for(auto &obstacle : obstacles)
+// "lab05 --stress [walls] [movers]": thousands of small walls and movers
+// wandering between them. B switches between the spatial hash and testing
+// every wall, the way moveInDirection used to; the console shows the time
+// spent on collision per frame for both.
+int runStress(sf::RenderWindow &window, const sf::Texture &wall_tex, const sf::Texture &guy_tex,
+              int wall_count, int mover_count)
+{
+    const sf::Vector2f world(1600.f, 1200.f);
+    window.setView(sf::View(sf::FloatRect(0, 0, world.x, world.y)));
+    std::mt19937 random(5);
+
+    sf::VertexArray wall_quads(sf::Quads);
+    std::vector<sf::FloatRect> walls;
+    SpatialHash wall_hash(32.f);
+    std::uniform_real_distribution<float> wall_x(0.f, world.x - 40.f);
+    std::uniform_real_distribution<float> wall_y(0.f, world.y - 40.f);
+    std::uniform_real_distribution<float> wall_size(6.f, 40.f);
+    for (int i = 0; i < wall_count; i++)
+    {
+        // Long and thin, lying or standing
+        float length = wall_size(random);
+        sf::FloatRect rect(wall_x(random), wall_y(random), length, 6.f);
+        if (i % 2)
         {
-            sf::FloatRect guy_bounds = getGlobalBounds();
-            sf::FloatRect wall_bounds = obstacle.getGlobalBounds();
-
-            if(Collision_T(wall_bounds, guy_bounds) == 1){top = 1;}
-            if(Collision_L(wall_bounds, guy_bounds) == 1){left = 1;}
-            if(Collision_B(wall_bounds, guy_bounds) == 1){bottom = 1;}
-            if(Collision_R(wall_bounds, guy_bounds) == 1){right = 1;}
+            std::swap(rect.width, rect.height);
         }
+        walls.emplace_back(rect);
+        wall_hash.insert(rect);
+        addQuad(wall_quads, rect, sf::Vector2f(rect.width, rect.height));
+    }
 
+    // Small guys, placed where no wall touches them
+    std::vector<Mover> movers(mover_count);
+    sf::Vector2f guy_size(guy_tex.getSize());
+    for (auto &mover : movers)
+    {
+        mover.sprite.setTexture(guy_tex);
+        mover.sprite.setScale(8.f / guy_size.x, 8.f / guy_size.y);
+        mover.sprite.setBounds(0, static_cast<int>(world.x), 0, static_cast<int>(world.y));
+        mover.sprite.setSpeed(60, 60);
+        for (int attempt = 0; attempt < 20; attempt++)
+        {
+            mover.sprite.setPosition(wall_x(random), wall_y(random));
+            if (wall_hash.contacts(mover.sprite.getGlobalBounds()) == 0)
+            {
+                break;
+            }
+        }
+    }
 
-        sf::FloatRect rectangle_bounds = getGlobalBounds();
+    std::uniform_int_distribution<int> direction(-1, 1);
+    std::uniform_real_distribution<float> turn_time(0.5f, 2.f);
+    sf::VertexArray mover_quads(sf::Quads);
+    bool use_hash = true;
+    sf::Clock clock;
+    sf::Clock report_clock;
+    float collision_ms = 0;
+    int frames = 0;
 
-        sf::Vector2f movement(0.f, 0.f);
+    while (window.isOpen())
+    {
+        sf::Time elapsed = clock.restart();
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) && (rectangle_bounds.left + rectangle_bounds.width < bound_right) && right == 0) {
-            movement.x = m_speed_x * elapsed.asSeconds() * 1;
+        sf::Event event;
+        while (window.pollEvent(event))
+        {
+            if (event.type == sf::Event::Closed)
+            {
+                window.close();
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::B)
+            {
+                use_hash = !use_hash;
+            }
         }
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) && (rectangle_bounds.left > bound_left) && left == 0) {
-            movement.x = m_speed_x * elapsed.asSeconds() * -1;
-        }
+        sf::Clock collision_clock;
+        for (auto &mover : movers)
+        {
+            mover.turn_in -= elapsed.asSeconds();
+            if (mover.turn_in <= 0)
+            {
+                mover.dir_x = direction(random);
+                mover.dir_y = direction(random);
+                mover.turn_in = turn_time(random);
+            }
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up) && (rectangle_bounds.top > bound_top) && top == 0) {
-            movement.y = m_speed_y * elapsed.asSeconds() * -1;
+            sf::FloatRect bounds = mover.sprite.getGlobalBounds();
+            unsigned contacts = 0;
+            if (use_hash)
+            {
+                contacts = wall_hash.contacts(bounds);
+            }
+            else
+            {
+                for (const auto &wall : walls)
+                {
+                    contacts |= contactMask(wall, bounds);
+                }
+            }
+            mover.sprite.moveTowards(elapsed, contacts, mover.dir_x > 0, mover.dir_x < 0, mover.dir_y < 0, mover.dir_y > 0);
         }
+        collision_ms += collision_clock.getElapsedTime().asSeconds() * 1000.f;
+        frames++;
 
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down) && (rectangle_bounds.top + rectangle_bounds.height < bound_bottom) && bottom == 0) {
-            movement.y = m_speed_y * elapsed.asSeconds() * 1;
+        if (report_clock.getElapsedTime().asSeconds() >= 1.f)
+        {
+            std::cout << wall_count << " walls, " << mover_count << " movers, "
+                      << (use_hash ? "spatial hash" : "every wall") << ": "
+                      << collision_ms / frames << " ms collision per frame, "
+                      << frames / report_clock.restart().asSeconds() << " fps" << std::endl;
+            collision_ms = 0;
+            frames = 0;
         }
 
-        move(movement);
-
+        mover_quads.clear();
+        for (const auto &mover : movers)
+        {
+            addQuad(mover_quads, mover.sprite.getGlobalBounds(), guy_size);
+        }
 
+        window.clear(sf::Color::Black);
+        window.draw(wall_quads, &wall_tex);
+        window.draw(mover_quads, &guy_tex);
+        window.display();
     }
 
+    return 0;
+}
 
-private:
-    int m_speed_x = 200;
-    int m_speed_y = 200;
-    int bound_top = 0;
-    int bound_bottom = 0;
-    int bound_left = 0;
-    int bound_right = 0;
-};
-
-int main()
+int main(int argc, char *argv[])
 {
 
     sf::RenderWindow window(sf::VideoMode(800, 600), "My window");
@@ -141,6 +247,13 @@ int main()
     }
     wall_tex.setRepeated(true);
 
+    if (argc >= 2 && std::string(argv[1]) == "--stress")
+    {
+        int wall_count = argc >= 3 ? std::atoi(argv[2]) : 5000;
+        int mover_count = argc >= 4 ? std::atoi(argv[3]) : 2000;
+        return runStress(window, wall_tex, guy_tex, wall_count, mover_count);
+    }
+
     CustomSprite guy;
     guy.setTexture(guy_tex);
 
@@ -189,6 +302,9 @@ int main()
     walls.emplace_back(wall5);
     walls.emplace_back(wall6);
 
+    // The walls never move, so their bounds are hashed once
+    SpatialHash wall_hash;
+    wall_hash.build(walls);
 
 
 
@@ -206,7 +322,7 @@ int main()
         }
 
         guy.setBounds(0, window.getSize().x, 0, window.getSize().y);
-        guy.moveInDirection(elapsed, walls);
+        guy.moveInDirection(elapsed, wall_hash);
 
         window.clear(sf::Color::Black);
         window.draw(grass);